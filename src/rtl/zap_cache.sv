@@ -28,7 +28,8 @@ parameter [31:0] LPAGE_TLB_ENTRIES      = 32'd8,
 parameter [31:0] SECTION_TLB_ENTRIES    = 32'd8,
 parameter [31:0] FPAGE_TLB_ENTRIES      = 32'd8,
 parameter [31:0] CACHE_LINE             = 32'd8,
-parameter [31:0] CPSR_MODE              = 32'd4
+parameter [31:0] CPSR_MODE              = 32'd4,
+parameter [31:0] WB_DATA_WIDTH          = 32'd32 // 32 or 64.
 
 )
 (
@@ -78,31 +79,37 @@ input   logic [31:0]           i_dac_reg,
 input  logic                   i_tlb_inv,
 
 // Wishbone. Signals from all 4 modules are ORed.
-output logic              o_wb_stb, o_wb_stb_nxt,
-output logic              o_wb_cyc, o_wb_cyc_nxt,
-output logic              o_wb_wen, o_wb_wen_nxt,
-output logic  [3:0]       o_wb_sel, o_wb_sel_nxt,
-output logic  [31:0]      o_wb_dat, o_wb_dat_nxt,
-output logic  [31:0]      o_wb_adr, o_wb_adr_nxt,
-output logic  [2:0]       o_wb_cti, o_wb_cti_nxt,
-input  logic [31:0]       i_wb_dat,
-input  logic              i_wb_ack,
-input  logic              i_wb_err
+output logic                         o_wb_stb, o_wb_stb_nxt,
+output logic                         o_wb_cyc, o_wb_cyc_nxt,
+output logic                         o_wb_wen, o_wb_wen_nxt,
+output logic  [WB_DATA_WIDTH/8-1:0]  o_wb_sel, o_wb_sel_nxt,
+output logic  [WB_DATA_WIDTH-1:0]    o_wb_dat, o_wb_dat_nxt,
+output logic  [31:0]                 o_wb_adr, o_wb_adr_nxt,
+output logic  [2:0]                  o_wb_cti, o_wb_cti_nxt,
+input logic   [WB_DATA_WIDTH-1:0]    i_wb_dat,
+input logic                          i_wb_ack,
+input logic                          i_wb_err
 
 );
 
 `include "zap_defines.svh"
 `include "zap_localparams.svh"
+`include "zap_functions.svh"
 
 localparam [2:0] SELECT_CCH = 3'b001;
 localparam [2:0] SELECT_TAG = 3'b010;
 localparam [2:0] SELECT_TLB = 3'b100;
 
+localparam [31:0] WB_BYTES = WB_DATA_WIDTH / 32'd8;
+localparam [0:0]  WB_64    = WB_DATA_WIDTH == 32'd64;
+
 logic [2:0]                      wb_stb;
 logic [2:0]                      wb_cyc;
 logic [2:0]                      wb_wen;
-logic [3:0]                      wb_sel [2:0];
-logic [31:0]                     wb_dat [2:0];
+logic [WB_DATA_WIDTH/8-1:0]      wb_sel [2:0];
+logic [WB_DATA_WIDTH-1:0]        wb_dat [2:0];
+logic [3:0]                      tlb_wb_sel;
+logic [31:0]                     tlb_wb_dat;
 logic [31:0]                     wb_adr [2:0];
 logic [2:0]                      wb_cti [2:0];
 logic [31:0]                     tlb_phy_addr;
@@ -135,7 +142,7 @@ assign wb_cti[2] = CTI_EOB;
 assign unused = |{wb_err[1]};
 
 // Basic cache FSM - serves as manager 0.
-zap_cache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE)) u_zap_cache_fsm (
+zap_cache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .WB_DATA_WIDTH(WB_DATA_WIDTH)) u_zap_cache_fsm (
         .i_clk                  (i_clk),
         .i_reset                (i_reset),
         .i_address              (i_address),
@@ -200,7 +207,7 @@ zap_cache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE)) u_zap_cache_fs
 );
 
 // Cache Tag RAM - As a manager - this performs cache clean - manager 1.
-zap_cache_tag_ram #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE)) u_zap_cache_tag_ram     (
+zap_cache_tag_ram #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .WB_DATA_WIDTH(WB_DATA_WIDTH)) u_zap_cache_tag_ram     (
         .i_clk                  (i_clk),
         .i_reset                (i_reset),
         .i_address_nxt          (i_address_nxt),
@@ -276,13 +283,17 @@ u_zap_tlb (
         .o_wb_cyc_nxt   (wb_cyc[2]),
         .o_wb_adr_nxt   (wb_adr[2]),
         .o_wb_wen_nxt   (wb_wen[2]),
-        .o_wb_sel_nxt   (wb_sel[2]),
-        .o_wb_dat_nxt   (wb_dat[2]),
-        .i_wb_dat       (i_wb_dat),
+        .o_wb_sel_nxt   (tlb_wb_sel),
+        .o_wb_dat_nxt   (tlb_wb_dat),
+        .i_wb_dat       (wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr[2])),
         .i_wb_ack       (wb_ack[2]),
         .i_wb_err       (wb_err[2])
 );
 
+// The TLB does 32-bit reads. Move them to the right lane on a 64-bit bus.
+assign wb_sel[2] = WB_BYTES'(wb_lane_sel(tlb_wb_sel, WB_64 && wb_adr[2][2]));
+assign wb_dat[2] = {(WB_DATA_WIDTH/32){tlb_wb_dat}};
+
 // Sequential Block
 always_ff @ ( posedge i_clk )
 begin
@@ -25,7 +25,8 @@
 
 module zap_cache_fsm   #(
         parameter logic [31:0] CACHE_SIZE    = 32'd1024,  // Bytes.
-        parameter logic [31:0] CACHE_LINE    = 32'd8
+        parameter logic [31:0] CACHE_LINE    = 32'd8,
+        parameter logic [31:0] WB_DATA_WIDTH = 32'd32     // 32 or 64.
 )
 
 // ----------------------------------------------
@@ -95,16 +96,16 @@ output  logic                      o_hold,
 output  logic                      o_idle,
 
 // Bus access ports.
-output  logic                   o_wb_cyc_ff, o_wb_cyc_nxt,
-output  logic                   o_wb_stb_ff, o_wb_stb_nxt,
-output  logic     [31:0]        o_wb_adr_ff, o_wb_adr_nxt,
-output  logic     [31:0]        o_wb_dat_ff, o_wb_dat_nxt,
-output  logic     [3:0]         o_wb_sel_ff, o_wb_sel_nxt,
-output  logic                   o_wb_wen_ff, o_wb_wen_nxt,
-output  logic     [2:0]         o_wb_cti_ff, o_wb_cti_nxt,
-input   logic                   i_wb_ack,
-input   logic    [31:0]         i_wb_dat,
-input   logic                   i_wb_err
+output  logic                             o_wb_cyc_ff, o_wb_cyc_nxt,
+output  logic                             o_wb_stb_ff, o_wb_stb_nxt,
+output  logic     [31:0]                  o_wb_adr_ff, o_wb_adr_nxt,
+output  logic     [WB_DATA_WIDTH-1:0]     o_wb_dat_ff, o_wb_dat_nxt,
+output  logic     [WB_DATA_WIDTH/8-1:0]   o_wb_sel_ff, o_wb_sel_nxt,
+output  logic                             o_wb_wen_ff, o_wb_wen_nxt,
+output  logic     [2:0]                   o_wb_cti_ff, o_wb_cti_nxt,
+input   logic                             i_wb_ack,
+input   logic     [WB_DATA_WIDTH-1:0]     i_wb_dat,
+input   logic                             i_wb_err
 
 );
 
@@ -114,6 +115,7 @@ input   logic                   i_wb_err
 
 `include "zap_localparams.svh"
 `include "zap_defines.svh"
+`include "zap_functions.svh"
 
 // States
 localparam [2:0] IDLE                 = 3'd0; // Resting state.
@@ -126,9 +128,15 @@ localparam [2:0] CLEAN                = 3'd6; // Cache clean parent state
 
 localparam [31:0] NUMBER_OF_STATES    = 32'd7;
 
-localparam [31:0] ADR_PAD              =  32'd32 - $clog2(CACHE_LINE/4) - 32'd1;
-localparam [31:0] ADR_PAD_MINUS_2      =  ADR_PAD - 32'd2;
+// Bus width. Lines are moved WB_BYTES at a time.
+localparam [31:0] WB_BYTES             =  WB_DATA_WIDTH / 32'd8;   // Bytes per beat.
+localparam [31:0] WB_WORDS             =  WB_DATA_WIDTH / 32'd32;  // Words per beat.
+localparam [31:0] BEATS                =  CACHE_LINE / WB_BYTES;   // Beats per line.
+localparam [0:0]  WB_64                =  WB_DATA_WIDTH == 32'd64;
+
+localparam [31:0] ADR_PAD              =  32'd32 - $clog2(BEATS) - 32'd1;
 localparam [31:0] LINE_PAD             = (CACHE_LINE * 32'd8) - 32'd32;
+localparam [31:0] WORD_WDT             =  $clog2(CACHE_LINE/4);
 
 // ----------------------------------------------------------------------------
 // Variables
@@ -144,7 +152,7 @@ logic                                     cache_clean_req_nxt,
                                           cache_clean_req_ff;
 logic                                     cache_inv_req_nxt,
                                           cache_inv_req_ff;
-logic [$clog2(CACHE_LINE/4):0]            adr_ctr_ff, adr_ctr_nxt; // Needs to take on 0,1,2,3, ... CACHE_LINE/4
+logic [$clog2(BEATS):0]                   adr_ctr_ff, adr_ctr_nxt; // Needs to take on 0,1,2,3, ... BEATS
 logic                                     rhit, whit;              // For debug only.
 
 // From/to processor
@@ -243,9 +251,9 @@ begin
         o_idle <= ~(|state_nxt);
 end
 
-// Output data port.
+// Output data port. On a 64-bit bus, pick the 32-bit lane that was accessed.
 assign o_dat = state_ff == UNCACHEABLE ?
-               i_wb_dat :
+               wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr_ff[2]) :
                adapt_cache_data(i_address[$clog2(CACHE_LINE)-1:2], i_cache_line);
 
 // ==========================================================
@@ -260,6 +268,7 @@ begin:blk1
        // ----------------------------------------
 
        logic [$clog2(CACHE_LINE/4)-1:0] tmp;
+       logic [$clog2(CACHE_LINE/4)-1:0] widx;
 
         // ---------------------------------------
         // Default Values Section
@@ -267,6 +276,7 @@ begin:blk1
         // ---------------------------------------
 
         tmp                     = {($clog2(CACHE_LINE/4)){1'd0}};
+        widx                    = {($clog2(CACHE_LINE/4)){1'd0}};
         state_nxt               = state_ff;
         adr_ctr_nxt             = adr_ctr_ff;
         o_wb_cyc_nxt            = o_wb_cyc_ff;
@@ -348,9 +358,9 @@ begin:blk1
                                 o_wb_stb_nxt    = 1'd1;
                                 o_wb_cyc_nxt    = 1'd1;
                                 o_wb_adr_nxt    = i_address;
-                                o_wb_dat_nxt    = i_din;
+                                o_wb_dat_nxt    = {WB_WORDS{i_din}};
                                 o_wb_wen_nxt    = i_wr;
-                                o_wb_sel_nxt    = i_ben;
+                                o_wb_sel_nxt    = WB_BYTES'(wb_lane_sel(i_ben, WB_64 && i_address[2]));
                                 o_wb_cti_nxt    = CTI_EOB;
                         end
                         else if ( i_cacheable )
@@ -443,9 +453,9 @@ begin:blk1
                 o_wb_stb_nxt    = 1'd1;
                 o_wb_cyc_nxt    = 1'd1;
                 o_wb_adr_nxt    = i_phy_addr;
-                o_wb_dat_nxt    = i_din;
+                o_wb_dat_nxt    = {WB_WORDS{i_din}};
                 o_wb_wen_nxt    = i_wr;
-                o_wb_sel_nxt    = i_ben;
+                o_wb_sel_nxt    = WB_BYTES'(wb_lane_sel(i_ben, WB_64 && i_phy_addr[2]));
                 o_wb_cti_nxt    = CTI_EOB;
         end
 
@@ -475,10 +485,10 @@ begin:blk1
                 o_err2 = i_rd || i_wr ? 1'd1 : 1'd0;
 
                 // Generate address
-                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(CACHE_LINE/4) ){1'd0}}, 1'd1} :
-                                                                         {($clog2(CACHE_LINE/4)+1){1'd0}});
+                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(BEATS) ){1'd0}}, 1'd1} :
+                                                                         {($clog2(BEATS)+1){1'd0}});
 
-                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= ((CACHE_LINE/4) - 1) )
+                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= (BEATS - 1) )
                 begin
                         // Sync up with memory. Use PA in cache tag itself.
                         o_wb_cyc_nxt = 1'd1;
@@ -486,10 +496,10 @@ begin:blk1
                         o_wb_wen_nxt = 1'd1;
                         o_wb_dat_nxt = clean_single_d(cache_line, adr_ctr_nxt);
                         o_wb_adr_nxt = {cache_tag[`ZAP_CACHE_TAG__PA], {$clog2(CACHE_LINE){1'd0}}} +
-                                       ({{ADR_PAD_MINUS_2{1'd0}}, adr_ctr_nxt, 2'd0});
-                        o_wb_cti_nxt = {{ADR_PAD{1'd0}},adr_ctr_nxt} != ((CACHE_LINE/4) - 1) ?
+                                       ({{ADR_PAD{1'd0}}, adr_ctr_nxt} * WB_BYTES);
+                        o_wb_cti_nxt = {{ADR_PAD{1'd0}},adr_ctr_nxt} != (BEATS - 1) ?
                                        CTI_BURST : CTI_EOB;
-                        o_wb_sel_nxt = 4'b1111;
+                        o_wb_sel_nxt = {WB_BYTES{1'd1}};
                 end
                 else
                 begin
@@ -511,13 +521,15 @@ begin:blk1
                 o_err2 = i_rd || i_wr ? 1'd1 : 1'd0;
 
                 // Generate address
-                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(CACHE_LINE/4) ){1'd0}}, 1'd1} :
-                                                                         {($clog2(CACHE_LINE/4)+1){1'd0}}) ;
+                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(BEATS) ){1'd0}}, 1'd1} :
+                                                                         {($clog2(BEATS)+1){1'd0}}) ;
 
-                // Write to buffer
-                buf_nxt[adr_ctr_ff[$clog2(CACHE_LINE/4)-1:0]] = (i_wb_ack|i_wb_err) ?
-                                                                i_wb_dat :
-                                                                buf_ff[adr_ctr_ff[$clog2(CACHE_LINE/4)-1:0]];
+                // Write to buffer. Each beat carries WB_WORDS words.
+                for(int i=0;i<WB_WORDS;i++)
+                begin
+                        widx          = WORD_WDT'(({{ADR_PAD{1'd0}}, adr_ctr_ff} * WB_WORDS) + i);
+                        buf_nxt[widx] = (i_wb_ack|i_wb_err) ? i_wb_dat[i*32 +: 32] : buf_ff[widx];
+                end
 
                 // Manipulate buffer as needed
                 if ( wr )
@@ -530,14 +542,14 @@ begin:blk1
                         buf_nxt[tmp][31:24] = ben[3] ? din[31:24] : buf_nxt[tmp][31:24];
                 end
 
-                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= (CACHE_LINE/4) - 1 )
+                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= BEATS - 1 )
                 begin
 
                         // Fetch line from memory
                         `zap_wb_prpr_read(
                                      {phy_addr[31:$clog2(CACHE_LINE)], {$clog2(CACHE_LINE){1'd0}}} +
-                                     (adr_ctr_nxt * (32/8)),
-                                     ({{ADR_PAD{1'd0}}, adr_ctr_nxt} != CACHE_LINE/4 - 1) ? CTI_BURST : CTI_EOB);
+                                     (adr_ctr_nxt * WB_BYTES),
+                                     ({{ADR_PAD{1'd0}}, adr_ctr_nxt} != BEATS - 1) ? CTI_BURST : CTI_EOB);
                 end
                 else
                 begin:blk12
@@ -601,6 +613,7 @@ begin:blk1
                 // in better synthesis.
 
                 tmp                     = 'x;
+                widx                    = 'x;
                 state_nxt               = 'x;
                 adr_ctr_nxt             = 'x;
                 o_wb_cyc_nxt            = 'x;
@@ -671,18 +684,18 @@ localparam [31:0] W = $clog2(CACHE_LINE);
 
 endfunction : ben_comp
 
-function automatic [31:0] clean_single_d (
+function automatic [WB_DATA_WIDTH-1:0] clean_single_d (
         input [CACHE_LINE*8-1:0]        cl,
-        input [$clog2(CACHE_LINE/4):0]  sh
+        input [$clog2(BEATS):0]         sh
 );
-logic [$clog2(CACHE_LINE/4) + 5:0] shamt;
+logic [$clog2(BEATS) + $clog2(WB_DATA_WIDTH):0] shamt;
 
 /* verilator lint_off UNUSEDSIGNAL */
-logic [CACHE_LINE*8-32-1:0] dummy;
+logic [CACHE_LINE*8-WB_DATA_WIDTH-1:0] dummy;
 /* verilator lint_on UNUSEDSIGNAL */
 
-        shamt                   = {sh, 5'd0};
-        {dummy, clean_single_d} = cl >> shamt; // Select specific 32-bit.
+        shamt                   = {sh, {$clog2(WB_DATA_WIDTH){1'd0}}};
+        {dummy, clean_single_d} = cl >> shamt; // Select specific beat.
 
 endfunction : clean_single_d
 
@@ -21,15 +21,20 @@
 // avoid translation during clean operations. The cache data RAM is also
 // present in this unit. This unit has a dedicated memory interface
 // because it can perform global clean and flush by itself without
-// depending on the cache controller.
+// depending on the cache controller. Clean and invalidate by VA range are
+// also done here, one line at a time, skipping lines that do not need
+// work. Optionally, dirty lines are written back one at a time when the
+// cache has been idle for a while (BG_WRITEBACK).
 //
 
 `include "zap_defines.svh"
 
 module zap_cache_tag_ram #(
 
-parameter logic [31:0] CACHE_SIZE = 32'd1024, // Bytes.
-parameter logic [31:0] CACHE_LINE = 32'd8
+parameter logic [31:0] CACHE_SIZE   = 32'd1024, // Bytes.
+parameter logic [31:0] CACHE_LINE   = 32'd8,
+parameter logic        BG_WRITEBACK = 1'd0,      // Background write back.
+parameter logic [31:0] WB_DATA_WIDTH= 32'd32      // 32 or 64.
 
 )(
 
@@ -61,6 +66,20 @@ input   logic                             i_cache_inv_req,
 output  logic                             o_cache_inv_done,
 /* verilator lint_on UNOPTFLAT */
 
+// Clean and/or invalidate lines whose VA falls in [start, end].
+input   logic                             i_cache_range_req,
+input   logic     [31:0]                  i_cache_range_start,
+input   logic     [31:0]                  i_cache_range_end,
+input   logic                             i_cache_range_clean,
+input   logic                             i_cache_range_inv,
+output  logic                             o_cache_range_done,
+
+// Background write back. Cache controller must be idle with no request
+// to start. Accesses must be replayed while o_bg_busy = 1.
+input   logic                             i_idle,
+input   logic                             i_req,
+output  logic                             o_bg_busy,
+
 //
 // Cache clean operations occur through these ports.
 // Bus access ports.
@@ -68,11 +87,11 @@ output  logic                             o_cache_inv_done,
 output  logic                             o_wb_cyc_ff, o_wb_cyc_nxt,
 output  logic                             o_wb_stb_ff, o_wb_stb_nxt,
 output  logic     [31:0]                  o_wb_adr_ff, o_wb_adr_nxt,
-output  logic     [31:0]                  o_wb_dat_ff, o_wb_dat_nxt,
-output  logic     [3:0]                   o_wb_sel_ff, o_wb_sel_nxt,
+output  logic     [WB_DATA_WIDTH-1:0]     o_wb_dat_ff, o_wb_dat_nxt,
+output  logic     [WB_DATA_WIDTH/8-1:0]   o_wb_sel_ff, o_wb_sel_nxt,
 output  logic                             o_wb_wen_ff, o_wb_wen_nxt,
 output  logic     [2:0]                   o_wb_cti_ff, o_wb_cti_nxt,
-input logic      [31:0]                   i_wb_dat,
+input logic      [WB_DATA_WIDTH-1:0]      i_wb_dat,
 input logic                               i_wb_ack
 
 );
@@ -82,23 +101,33 @@ input logic                               i_wb_ack
 `include "zap_localparams.svh"
 
 localparam [31:0] NUMBER_OF_DIRTY_BLOCKS = ((CACHE_SIZE/CACHE_LINE)/16); // Keep cache size > 16 bytes.
+localparam [31:0] NUMBER_OF_LINES        = CACHE_SIZE/CACHE_LINE;
 
 // States.
-typedef enum logic [6:0] {
-        IDLE                           = 7'b000_0001,
-        CACHE_CLEAN_GET_ADDRESS        = 7'b000_0010,
-        CACHE_CLEAN_WRITE_PRE_PRE_WAIT = 7'b000_0100,
-        CACHE_CLEAN_WRITE_PRE_WAIT     = 7'b000_1000,
-        CACHE_CLEAN_WRITE_PRE          = 7'b001_0000,
-        CACHE_CLEAN_WRITE              = 7'b010_0000,
-        CACHE_INV                      = 7'b100_0000,
+typedef enum logic [9:0] {
+        IDLE                           = 10'b00_0000_0001,
+        CACHE_CLEAN_GET_ADDRESS        = 10'b00_0000_0010,
+        CACHE_CLEAN_WRITE_PRE_PRE_WAIT = 10'b00_0000_0100,
+        CACHE_CLEAN_WRITE_PRE_WAIT     = 10'b00_0000_1000,
+        CACHE_CLEAN_WRITE_PRE          = 10'b00_0001_0000,
+        CACHE_CLEAN_WRITE              = 10'b00_0010_0000,
+        CACHE_INV                      = 10'b00_0100_0000,
+        RANGE_GET_ADDRESS              = 10'b00_1000_0000,
+        RANGE_CHECK                    = 10'b01_0000_0000,
+        RANGE_NEXT                     = 10'b10_0000_0000,
         `ZAP_DEFAULT_XX
 } t_state;
 
+// Bus width. Lines are written back WB_BYTES at a time.
+localparam [31:0] WB_BYTES    = WB_DATA_WIDTH / 8;
+localparam [31:0] BEATS       = CACHE_LINE / WB_BYTES;
+
 // Padding widths.
 localparam [31:0] BLK_CTR_PAD = 32 - $clog2(NUMBER_OF_DIRTY_BLOCKS) - 1;
-localparam [31:0] ADR_CTR_PAD = 32 - $clog2(CACHE_LINE/4) - 1;
-localparam [31:0] ZERO_WDT    = $clog2(CACHE_LINE/4) + 1;
+localparam [31:0] ADR_CTR_PAD = 32 - $clog2(BEATS) - 1;
+localparam [31:0] ZERO_WDT    = $clog2(BEATS) + 1;
+localparam [31:0] LINE_WDT    = 32 - $clog2(CACHE_LINE);
+localparam [31:0] LINE_PAD    = 32 - LINE_WDT;
 
 // ----------------------------------------------------------------------------
 
@@ -114,14 +143,27 @@ logic                                      tag_ram_clear;
 logic                                      tag_ram_clean;
 t_state                                    state_ff, state_nxt;
 logic [$clog2(NUMBER_OF_DIRTY_BLOCKS):0]   blk_ctr_ff, blk_ctr_nxt;
-logic [$clog2(CACHE_LINE/4):0]             adr_ctr_ff, adr_ctr_nxt;
+logic [$clog2(BEATS):0]                    adr_ctr_ff, adr_ctr_nxt;
 logic                                      cache_tag_dirty, cache_tag_dirty_del;
 logic                                      cache_tag_valid, cache_tag_valid_del;
 logic                                      cache_clean_done_nxt, cache_clean_done_ff;
+logic                                      tag_ram_inv_line;
+logic                                      range_ff, range_nxt;
+logic                                      range_done_ff, range_done_nxt;
+logic [$clog2(NUMBER_OF_LINES):0]          range_ctr_ff, range_ctr_nxt;
+logic [$clog2(NUMBER_OF_LINES):0]          range_cnt;
+logic [$clog2(NUMBER_OF_LINES)-1:0]        range_idx;
+logic [LINE_WDT-1:0]                       range_line_start, range_line_end;
+logic                                      range_hit;
+logic                                      bg_ff, bg_nxt;
+logic                                      bg_start;
+logic [$clog2(NUMBER_OF_DIRTY_BLOCKS):0]   bg_blk_ff, bg_blk_nxt;
+logic [3:0]                                bg_idle_ctr_ff;
+logic [2:0]                                bg_tail_ff, bg_tail_nxt;
 
 logic                                      unused;
 logic [BLK_CTR_PAD-1:0]                    dummy;
-logic [CACHE_LINE*8-32-1:0]                line_dummy;
+logic [CACHE_LINE*8-WB_DATA_WIDTH-1:0]     line_dummy;
 logic                                      cache_unused0;
 logic                                      cache_unused1;
 logic [CACHE_LINE*8-1:0]                   w_dummy;
@@ -179,17 +221,22 @@ begin
                 cache_tag_dirty       <= '0;
                 dirty                 <= '0;
         end
-        else if ( !i_hold || tag_ram_clean )
+        else if ( !i_hold || tag_ram_clean || tag_ram_clear || tag_ram_inv_line )
         begin
                 o_cache_tag_dirty  <= tag_ram_rd_addr_del2 == tag_ram_wr_addr && tag_ram_wr_en ? i_cache_tag_dirty : cache_tag_dirty_del;
                 cache_tag_dirty_del<= tag_ram_rd_addr_del  == tag_ram_wr_addr && tag_ram_wr_en ? i_cache_tag_dirty : cache_tag_dirty;
                 cache_tag_dirty    <= tag_ram_rd_addr      == tag_ram_wr_addr && tag_ram_wr_en ? i_cache_tag_dirty : dirty [ tag_ram_rd_addr ];
 
-                if ( tag_ram_wr_en )
+                if ( tag_ram_clear )
+                begin
+                        // Invalid lines must not be written back later.
+                        dirty <= '0;
+                end
+                else if ( tag_ram_wr_en )
                 begin
                         dirty [ tag_ram_wr_addr ]   <= i_cache_tag_dirty;
                 end
-                else if ( tag_ram_clean )
+                else if ( tag_ram_clean || tag_ram_inv_line )
                 begin
                         dirty[tag_ram_rd_addr] <= 1'd0;
                 end
@@ -205,7 +252,7 @@ begin
                 cache_tag_valid     <= '0;
                 valid               <= '0;
         end
-        else if ( !i_hold || tag_ram_clear )
+        else if ( !i_hold || tag_ram_clear || tag_ram_inv_line )
         begin
                 o_cache_tag_valid   <= tag_ram_rd_addr_del2 == tag_ram_wr_addr && tag_ram_wr_en ? 1'd1 : cache_tag_valid_del;
                 cache_tag_valid_del <= tag_ram_rd_addr_del  == tag_ram_wr_addr && tag_ram_wr_en ? 1'd1 : cache_tag_valid;
@@ -219,6 +266,10 @@ begin
                 begin
                         valid [ tag_ram_wr_addr ]   <= 1'd1;
                 end
+                else if ( tag_ram_inv_line )
+                begin
+                        valid [ tag_ram_rd_addr ]   <= 1'd0;
+                end
         end
 end
 
@@ -239,6 +290,12 @@ begin
                 blk_ctr_ff              <= 0;
                 cache_clean_done_ff     <= 0;
                 tag_ram_rd_addr_ff      <= 0;
+                range_ff                <= 0;
+                range_done_ff           <= 0;
+                range_ctr_ff            <= 0;
+                bg_ff                   <= 0;
+                bg_blk_ff               <= 0;
+                bg_tail_ff              <= 0;
 
                 // STATE
                 state_ff                <= IDLE;
@@ -256,12 +313,79 @@ begin
                 blk_ctr_ff              <= blk_ctr_nxt;
                 cache_clean_done_ff     <= cache_clean_done_nxt;
                 tag_ram_rd_addr_ff      <= tag_ram_rd_addr_nxt;
+                range_ff                <= range_nxt;
+                range_done_ff           <= range_done_nxt;
+                range_ctr_ff            <= range_ctr_nxt;
+                bg_ff                   <= bg_nxt;
+                bg_blk_ff               <= bg_blk_nxt;
+                bg_tail_ff              <= bg_tail_nxt;
 
                 // STATE
                 state_ff                <= state_nxt;
         end
 end
 
+// Counts cycles for which the cache controller is idle with no requests.
+always_ff @ ( posedge i_clk )
+begin
+        if ( i_reset || i_req || !i_idle )
+        begin
+                bg_idle_ctr_ff <= 4'd0;
+        end
+        else if ( !(&bg_idle_ctr_ff) )
+        begin
+                bg_idle_ctr_ff <= bg_idle_ctr_ff + 4'd1;
+        end
+end
+
+// ----------------------------------------------------------------------------
+
+// Range in terms of line addresses. Start and end are inclusive.
+assign range_line_start = i_cache_range_start[31:$clog2(CACHE_LINE)];
+assign range_line_end   = i_cache_range_end  [31:$clog2(CACHE_LINE)];
+
+// Number of lines to examine. Capped at the number of lines in the cache.
+always_comb
+begin:blk0
+        logic [31:0] diff;
+
+        diff = {{LINE_PAD{1'd0}}, range_line_end} - {{LINE_PAD{1'd0}}, range_line_start};
+
+        if ( range_line_end < range_line_start )
+        begin
+                range_cnt = '0;
+        end
+        else if ( diff >= NUMBER_OF_LINES - 1 )
+        begin
+                range_cnt = NUMBER_OF_LINES[$clog2(NUMBER_OF_LINES):0];
+        end
+        else
+        begin
+                range_cnt = diff[$clog2(NUMBER_OF_LINES):0] +
+                            {{$clog2(NUMBER_OF_LINES){1'd0}}, 1'd1};
+        end
+end : blk0
+
+// Index of the line being examined. Wraps around.
+assign range_idx = range_line_start[$clog2(NUMBER_OF_LINES)-1:0] +
+                   range_ctr_ff[$clog2(NUMBER_OF_LINES)-1:0];
+
+// Line being examined is valid and its VA falls in the range.
+assign range_hit = valid[tag_ram_rd_addr_ff] &&
+                  ({o_cache_tag[`ZAP_CACHE_TAG__TAG], tag_ram_rd_addr_ff} >= range_line_start) &&
+                  ({o_cache_tag[`ZAP_CACHE_TAG__TAG], tag_ram_rd_addr_ff} <= range_line_end);
+
+// Start background write back when nothing else is going on.
+assign bg_start = BG_WRITEBACK && i_cache_en && i_idle && !i_req &&
+                  (&bg_idle_ctr_ff) && (|dirty) &&
+                  !i_cache_clean_req && !i_cache_inv_req && !i_cache_range_req &&
+                  !cache_clean_done_ff && !range_done_ff;
+
+// Also covers the RAM read latency after returning to IDLE.
+assign o_bg_busy = bg_ff || (|bg_tail_ff);
+
+assign o_cache_range_done = range_done_ff;
+
 // ----------------------------------------------------------------------------
 
 assign tag_ram_rd_addr = state_ff == IDLE ?
@@ -275,27 +399,36 @@ begin:blk1
         // Local Vars Section
         // --------------------------------------------------
 
-        logic [31:0] shamt, data, pa;
+        logic [31:0]              shamt, pa;
+        logic [WB_DATA_WIDTH-1:0] data;
 
         // --------------------------------------------------
         // Defaults Value Section
         // (Done to avoid combo loops/incomplete assignments).
         // --------------------------------------------------
 
-        line_dummy              = {(CACHE_LINE*8-32){1'd0}};
+        line_dummy              = {(CACHE_LINE*8-WB_DATA_WIDTH){1'd0}};
         shamt                   = '0;
         data                    = '0;
         pa                      = '0;
         dummy                   = '0;
         state_nxt               = state_ff;
-        tag_ram_rd_addr_nxt     = get_tag_ram_rd_addr (blk_ctr_ff, dirty);
+        tag_ram_rd_addr_nxt     = range_ff ? range_idx :
+                                  get_tag_ram_rd_addr (blk_ctr_ff, dirty);
         tag_ram_wr_addr         = i_address[`ZAP_VA__CACHE_INDEX];
         tag_ram_wr_en           = 0;
         tag_ram_clear           = 0;
         tag_ram_clean           = 0;
+        tag_ram_inv_line        = 0;
         adr_ctr_nxt             = adr_ctr_ff;
         blk_ctr_nxt             = blk_ctr_ff;
         cache_clean_done_nxt    = cache_clean_done_ff;
+        range_nxt               = range_ff;
+        range_done_nxt          = range_done_ff;
+        range_ctr_nxt           = range_ctr_ff;
+        bg_nxt                  = bg_ff;
+        bg_blk_nxt              = bg_blk_ff;
+        bg_tail_nxt             = bg_tail_ff >> 1;
         o_cache_inv_done        = 0;
         o_wb_cyc_nxt            = o_wb_cyc_ff;
         o_wb_stb_nxt            = o_wb_stb_ff;
@@ -322,6 +455,9 @@ begin:blk1
                 tag_ram_wr_data = i_cache_tag;
 
                 cache_clean_done_nxt = 1'd0;
+                range_done_nxt       = 1'd0;
+                range_nxt            = 1'd0;
+                bg_nxt               = 1'd0;
 
                 if ( i_cache_clean_req && !cache_clean_done_ff )
                 begin
@@ -335,11 +471,42 @@ begin:blk1
                         tag_ram_wr_en = 0;
                         state_nxt     = CACHE_INV;
                 end
+                else if ( i_cache_range_req && !range_done_ff )
+                begin
+                        tag_ram_wr_en = 0;
+                        range_ctr_nxt = 0;
+                        range_nxt     = 1'd1;
+
+                        state_nxt     = RANGE_GET_ADDRESS;
+                end
+                else if ( bg_start )
+                begin
+                        if ( &baggage(dirty, bg_blk_ff) )
+                        begin
+                                // Nothing dirty here. Look at next block.
+                                bg_blk_nxt = {{BLK_CTR_PAD{1'd0}}, bg_blk_ff} == NUMBER_OF_DIRTY_BLOCKS - 1 ?
+                                             '0 : bg_blk_ff + 1'd1;
+                        end
+                        else
+                        begin
+                                // Write back one line from this block.
+                                blk_ctr_nxt = bg_blk_ff;
+                                bg_nxt      = 1'd1;
+
+                                state_nxt   = CACHE_CLEAN_GET_ADDRESS;
+                        end
+                end
         end
 
         CACHE_CLEAN_GET_ADDRESS:
         begin
-                if ( &baggage(dirty, blk_ctr_ff) )
+                if ( bg_ff && (&baggage(dirty, blk_ctr_ff)) )
+                begin
+                        // Line became clean. Nothing to do.
+                        bg_tail_nxt = 3'b111;
+                        state_nxt   = IDLE;
+                end
+                else if ( &baggage(dirty, blk_ctr_ff) )
                 begin
                         // Move to next block.
                         {dummy, blk_ctr_nxt} = {dummy, blk_ctr_ff} + 32'd1;
@@ -371,7 +538,7 @@ begin:blk1
 
         CACHE_CLEAN_WRITE_PRE: // Since RAM is pipelined.
         begin
-                state_nxt       = CACHE_CLEAN_WRITE;
+                state_nxt       = range_ff ? RANGE_CHECK : CACHE_CLEAN_WRITE;
         end
 
         CACHE_CLEAN_WRITE:
@@ -381,7 +548,7 @@ begin:blk1
                               {{(ZERO_WDT-1){1'd0}}, 1'd1} :
                               {ZERO_WDT{1'd0}});
 
-                if ( {{ADR_CTR_PAD{1'd0}}, adr_ctr_nxt} > ((CACHE_LINE/4) - 1) )
+                if ( {{ADR_CTR_PAD{1'd0}}, adr_ctr_nxt} > (BEATS - 1) )
                 begin
                         // Remove dirty marking. BUG FIX.
                         tag_ram_clean = 1;
@@ -390,11 +557,24 @@ begin:blk1
                         `zap_kill_access;
 
                         // Go to new state.
-                        state_nxt = CACHE_CLEAN_GET_ADDRESS;
+                        if ( range_ff )
+                        begin
+                                state_nxt = RANGE_NEXT;
+                        end
+                        else if ( bg_ff )
+                        begin
+                                // One line at a time.
+                                bg_tail_nxt = 3'b111;
+                                state_nxt   = IDLE;
+                        end
+                        else
+                        begin
+                                state_nxt = CACHE_CLEAN_GET_ADDRESS;
+                        end
                 end
                 else
                 begin
-                        shamt = {{(ADR_CTR_PAD-5){1'd0}}, adr_ctr_nxt, 5'd0};
+                        shamt = {{ADR_CTR_PAD{1'd0}}, adr_ctr_nxt} * WB_DATA_WIDTH;
                         {line_dummy, data}  = o_cache_line >> shamt;
 
                         pa    = {o_cache_tag[`ZAP_CACHE_TAG__PA],
@@ -407,10 +587,10 @@ begin:blk1
                         // Perform a Wishbone write using Physical Address.
                         // Uses WB burst protocol for higher efficency.
                         o_wb_dat_nxt = data;
-                        o_wb_adr_nxt = pa + ({{(ADR_CTR_PAD-2){1'd0}}, adr_ctr_nxt, 2'd0});
-                        o_wb_cti_nxt = ({{ADR_CTR_PAD{1'd0}},adr_ctr_nxt} != (CACHE_LINE/4)-1) ?
+                        o_wb_adr_nxt = pa + ({{ADR_CTR_PAD{1'd0}}, adr_ctr_nxt} * WB_BYTES);
+                        o_wb_cti_nxt = ({{ADR_CTR_PAD{1'd0}},adr_ctr_nxt} != BEATS-1) ?
                         CTI_BURST : CTI_EOB;
-                        o_wb_sel_nxt = 4'b1111;
+                        o_wb_sel_nxt = {WB_BYTES{1'd1}};
                 end
         end
 
@@ -421,6 +601,51 @@ begin:blk1
                 o_cache_inv_done = 1'd1;
         end
 
+        RANGE_GET_ADDRESS:
+        begin
+                adr_ctr_nxt = 0; // Initialize address counter.
+
+                if ( range_ctr_ff == range_cnt )
+                begin
+                        // All lines examined.
+                        state_nxt      = IDLE;
+                        range_done_nxt = 1'd1;
+                end
+                else if ( !valid[range_idx] || (!i_cache_range_inv && !dirty[range_idx]) )
+                begin
+                        // Nothing to do for this line. Skip without a read.
+                        range_ctr_nxt = range_ctr_ff + {{$clog2(NUMBER_OF_LINES){1'd0}}, 1'd1};
+                end
+                else
+                begin
+                        // Read the tag to check the VA.
+                        state_nxt = CACHE_CLEAN_WRITE_PRE_PRE_WAIT;
+                end
+        end
+
+        RANGE_CHECK:
+        begin
+                if ( range_hit && i_cache_range_clean && dirty[tag_ram_rd_addr_ff] )
+                begin
+                        state_nxt = CACHE_CLEAN_WRITE;
+                end
+                else
+                begin
+                        state_nxt = RANGE_NEXT;
+                end
+        end
+
+        RANGE_NEXT:
+        begin
+                if ( range_hit && i_cache_range_inv )
+                begin
+                        tag_ram_inv_line = 1'd1;
+                end
+
+                range_ctr_nxt = range_ctr_ff + {{$clog2(NUMBER_OF_LINES){1'd0}}, 1'd1};
+                state_nxt     = RANGE_GET_ADDRESS;
+        end
+
         // ------------------------------------------------------
         // Default Section (To simplify synthesis)
         // ------------------------------------------------------
@@ -440,9 +665,16 @@ begin:blk1
                 tag_ram_wr_en           = 'x;
                 tag_ram_clear           = 'x;
                 tag_ram_clean           = 'x;
+                tag_ram_inv_line        = 'x;
                 adr_ctr_nxt             = 'x;
                 blk_ctr_nxt             = 'x;
                 cache_clean_done_nxt    = 'x;
+                range_nxt               = 'x;
+                range_done_nxt          = 'x;
+                range_ctr_nxt           = 'x;
+                bg_nxt                  = 'x;
+                bg_blk_nxt              = 'x;
+                bg_tail_nxt             = 'x;
                 o_cache_inv_done        = 'x;
                 o_wb_cyc_nxt            = 'x;
                 o_wb_stb_nxt            = 'x;
@@ -0,0 +1,296 @@
+//
+// (C)2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//
+// A cluster of ZAP processors. Each core has its own caches and MMU. The
+// cores share a single Wishbone bus through a round robin/QoS arbiter. Core N
+// reads N from CP15 register 0 (opcode2 = 5).
+//
+// An inter core mailbox (see zap_mailbox) is mapped at MBOX_BASE. Accesses to
+// it do not appear on the external bus. The mailbox IRQ of a core is OR'ed
+// with its IRQ input. Note that the caches of the cores are not kept
+// coherent by hardware. The mailbox region must be mapped as uncacheable.
+//
+
+module zap_cluster #(
+
+// -----------------------------------
+// Number of cores. Must be < 32.
+// -----------------------------------
+
+parameter logic [31:0] CORES                    = 32'd2,
+
+// -----------------------------------
+// Mailbox base address. Must be aligned
+// to the mailbox size which is 8 x CORES
+// rounded up to a power of 2.
+// -----------------------------------
+
+parameter logic [31:0] MBOX_BASE                = 32'hFFFFFF40,
+
+// -----------------------------------
+// Wishbone data bus width. 32 or 64.
+// The mailbox sits on the lane
+// selected by address bit 2.
+// -----------------------------------
+
+parameter logic [31:0] WB_DATA_WIDTH            = 32'd32,
+
+// -----------------------------------
+// Per core configuration. Same as for
+// zap_top and applies to all cores.
+// -----------------------------------
+
+parameter logic [0:0]  CP15_L4_DEFAULT          = 1'd0,
+parameter logic [0:0]  ONLY_CORE                = 1'd0,
+parameter logic [31:0] RESET_VECTOR             = 32'd0,
+parameter logic [31:0] CPSR_INIT                = {24'd0, 1'd1,1'd1,1'd0,5'b10011},
+parameter logic [0:0]  BE_32_ENABLE             = 1'd0,
+parameter logic [31:0] BP_ENTRIES               = 32'd512,
+parameter logic [31:0] FIFO_DEPTH               = 32'd16,
+parameter logic [31:0] LOOP_BUFFER_DEPTH        = 32'd0,
+parameter logic [31:0] RAS_DEPTH                = 32'd4,
+parameter logic [31:0] DATA_SECTION_TLB_ENTRIES = 32'd4,
+parameter logic [31:0] DATA_LPAGE_TLB_ENTRIES   = 32'd8,
+parameter logic [31:0] DATA_SPAGE_TLB_ENTRIES   = 32'd16,
+parameter logic [31:0] DATA_FPAGE_TLB_ENTRIES   = 32'd32,
+parameter logic [31:0] DATA_CACHE_SIZE          = 32'd8192,
+parameter logic [31:0] DATA_CACHE_LINE          = 32'd64,
+parameter logic [0:0]  DATA_CACHE_BG_WRITEBACK  = 1'd0,
+parameter logic [31:0] CODE_SECTION_TLB_ENTRIES = 32'd4,
+parameter logic [31:0] CODE_LPAGE_TLB_ENTRIES   = 32'd8,
+parameter logic [31:0] CODE_SPAGE_TLB_ENTRIES   = 32'd16,
+parameter logic [31:0] CODE_FPAGE_TLB_ENTRIES   = 32'd32,
+parameter logic [31:0] CODE_CACHE_SIZE          = 32'd8192,
+parameter logic [31:0] CODE_CACHE_LINE          = 32'd64
+
+)(
+        `ifndef SYNTHESIS
+
+        // --------------------------------------
+        // Trace. Only for DV. Leave open.
+        // --------------------------------------
+
+        output  logic  [CORES-1:0][1023:0] o_trace,
+        output  logic  [CORES-1:0]         o_trace_valid,
+        output  logic  [CORES-1:0]         o_trace_uop_last,
+
+        `endif
+
+        // --------------------------------------
+        // Clock and reset
+        // --------------------------------------
+
+        input   logic                   i_clk,
+        input   logic                   i_reset,
+
+        // ---------------------------------------
+        // Interrupts. One pair per core. Active
+        // high and level triggered.
+        // ---------------------------------------
+
+        input   logic  [CORES-1:0]      i_irq,
+        input   logic  [CORES-1:0]      i_fiq,
+
+        // ---------------------------------------
+        // Bus QoS level of each core. Higher is
+        // more important. Tie to 0 for round
+        // robin.
+        // ---------------------------------------
+
+        input   logic  [CORES-1:0][1:0] i_qos,
+
+        // ---------------------
+        // Wishbone interface.
+        // ---------------------
+
+        output  logic                         o_wb_cyc,
+        output  logic                         o_wb_stb,
+        output  logic  [31:0]                 o_wb_adr,
+        output  logic                         o_wb_we,
+        output  logic  [WB_DATA_WIDTH-1:0]    o_wb_dat,
+        output  logic  [WB_DATA_WIDTH/8-1:0]  o_wb_sel,
+        output  logic  [2:0]                  o_wb_cti,
+        output  logic  [1:0]                  o_wb_bte,
+        input   logic                         i_wb_ack,
+        input   logic  [WB_DATA_WIDTH-1:0]    i_wb_dat,
+        input   logic                         i_wb_err,
+
+        // ---------------------------------------
+        // Bus request and grant of each core.
+        // For performance monitoring. Leave open
+        // if unused.
+        // ---------------------------------------
+
+        output  logic  [CORES-1:0]      o_bus_req,
+        output  logic  [CORES-1:0]      o_bus_gnt
+);
+
+`include "zap_defines.svh"
+`include "zap_localparams.svh"
+`include "zap_functions.svh"
+
+localparam [31:0] MBOX_WDT = (CORES > 1 ? $clog2(CORES) : 1) + 3;
+localparam [31:0] WB_WORDS = WB_DATA_WIDTH / 32;
+localparam [0:0]  WB_64    = WB_DATA_WIDTH == 32'd64;
+
+// Core side busses.
+logic [CORES-1:0]               core_wb_cyc;
+logic [CORES-1:0]               core_wb_stb;
+logic [CORES-1:0]               core_wb_we;
+logic [CORES-1:0][31:0]         core_wb_adr;
+logic [CORES-1:0][WB_DATA_WIDTH-1:0]   core_wb_dat;
+logic [CORES-1:0][WB_DATA_WIDTH/8-1:0] core_wb_sel;
+logic [CORES-1:0][2:0]          core_wb_cti;
+logic [CORES-1:0][1:0]          core_wb_bte;
+logic [CORES-1:0]               core_wb_ack;
+logic [CORES-1:0]               core_wb_err;
+logic [WB_DATA_WIDTH-1:0]       core_wb_din;
+
+// Arbitrated bus.
+logic                           arb_wb_cyc;
+logic                           arb_wb_stb;
+logic                           arb_wb_ack;
+logic                           arb_wb_err;
+
+// Mailbox.
+logic                           mbox_sel;
+logic                           mbox_wb_ack;
+logic [31:0]                    mbox_wb_dat;
+logic [CORES-1:0]               mbox_irq;
+
+// =========================
+// Processor cores.
+// =========================
+
+for(genvar i=0;i<CORES;i++)
+begin : l_core
+
+        zap_top #(
+                .CP15_L4_DEFAULT          (CP15_L4_DEFAULT),
+                .ONLY_CORE                (ONLY_CORE),
+                .RESET_VECTOR             (RESET_VECTOR),
+                .CPSR_INIT                (CPSR_INIT),
+                .BE_32_ENABLE             (BE_32_ENABLE),
+                .CORE_ID                  (8'(i)),
+                .WB_DATA_WIDTH            (WB_DATA_WIDTH),
+                .BP_ENTRIES               (BP_ENTRIES),
+                .FIFO_DEPTH               (FIFO_DEPTH),
+                .LOOP_BUFFER_DEPTH        (LOOP_BUFFER_DEPTH),
+                .RAS_DEPTH                (RAS_DEPTH),
+                .DATA_SECTION_TLB_ENTRIES (DATA_SECTION_TLB_ENTRIES),
+                .DATA_LPAGE_TLB_ENTRIES   (DATA_LPAGE_TLB_ENTRIES),
+                .DATA_SPAGE_TLB_ENTRIES   (DATA_SPAGE_TLB_ENTRIES),
+                .DATA_FPAGE_TLB_ENTRIES   (DATA_FPAGE_TLB_ENTRIES),
+                .DATA_CACHE_SIZE          (DATA_CACHE_SIZE),
+                .DATA_CACHE_LINE          (DATA_CACHE_LINE),
+                .DATA_CACHE_BG_WRITEBACK  (DATA_CACHE_BG_WRITEBACK),
+                .CODE_SECTION_TLB_ENTRIES (CODE_SECTION_TLB_ENTRIES),
+                .CODE_LPAGE_TLB_ENTRIES   (CODE_LPAGE_TLB_ENTRIES),
+                .CODE_SPAGE_TLB_ENTRIES   (CODE_SPAGE_TLB_ENTRIES),
+                .CODE_FPAGE_TLB_ENTRIES   (CODE_FPAGE_TLB_ENTRIES),
+                .CODE_CACHE_SIZE          (CODE_CACHE_SIZE),
+                .CODE_CACHE_LINE          (CODE_CACHE_LINE)
+        ) u_zap_top (
+                `ifndef SYNTHESIS
+                .o_trace                  (o_trace[i]),
+                .o_trace_valid            (o_trace_valid[i]),
+                .o_trace_uop_last         (o_trace_uop_last[i]),
+                `endif
+                .i_clk                    (i_clk),
+                .i_reset                  (i_reset),
+                .i_irq                    (i_irq[i] | mbox_irq[i]),
+                .i_fiq                    (i_fiq[i]),
+                .o_wb_cyc                 (core_wb_cyc[i]),
+                .o_wb_stb                 (core_wb_stb[i]),
+                .o_wb_adr                 (core_wb_adr[i]),
+                .o_wb_we                  (core_wb_we[i]),
+                .o_wb_dat                 (core_wb_dat[i]),
+                .o_wb_sel                 (core_wb_sel[i]),
+                .o_wb_cti                 (core_wb_cti[i]),
+                .o_wb_bte                 (core_wb_bte[i]),
+                .i_wb_ack                 (core_wb_ack[i]),
+                .i_wb_dat                 (core_wb_din),
+                .i_wb_err                 (core_wb_err[i])
+        );
+
+end : l_core
+
+// =========================
+// Bus arbiter.
+// =========================
+
+zap_wb_arbiter #(.MASTERS(CORES), .WB_DATA_WIDTH(WB_DATA_WIDTH)) u_zap_wb_arbiter (
+        .i_clk          (i_clk),
+        .i_reset        (i_reset),
+        .i_qos          (i_qos),
+        .i_wb_cyc       (core_wb_cyc),
+        .i_wb_stb       (core_wb_stb),
+        .i_wb_wen       (core_wb_we),
+        .i_wb_sel       (core_wb_sel),
+        .i_wb_dat       (core_wb_dat),
+        .i_wb_adr       (core_wb_adr),
+        .i_wb_cti       (core_wb_cti),
+        .i_wb_bte       (core_wb_bte),
+        .o_wb_ack       (core_wb_ack),
+        .o_wb_err       (core_wb_err),
+        .o_wb_cyc       (arb_wb_cyc),
+        .o_wb_stb       (arb_wb_stb),
+        .o_wb_wen       (o_wb_we),
+        .o_wb_sel       (o_wb_sel),
+        .o_wb_dat       (o_wb_dat),
+        .o_wb_adr       (o_wb_adr),
+        .o_wb_cti       (o_wb_cti),
+        .o_wb_bte       (o_wb_bte),
+        .i_wb_ack       (arb_wb_ack),
+        .i_wb_err       (arb_wb_err),
+        .o_req          (o_bus_req),
+        .o_gnt          (o_bus_gnt)
+);
+
+// =========================
+// Mailbox decode.
+// =========================
+
+assign mbox_sel    = o_wb_adr[31:MBOX_WDT] == MBOX_BASE[31:MBOX_WDT];
+
+assign o_wb_cyc    = arb_wb_cyc & ~mbox_sel;
+assign o_wb_stb    = arb_wb_stb & ~mbox_sel;
+assign arb_wb_ack  = mbox_sel ? mbox_wb_ack : i_wb_ack;
+assign arb_wb_err  = mbox_sel ? 1'd0        : i_wb_err;
+assign core_wb_din = mbox_sel ? {WB_WORDS{mbox_wb_dat}} : i_wb_dat;
+
+zap_mailbox #(.CORES(CORES)) u_zap_mailbox (
+        .i_clk          (i_clk),
+        .i_reset        (i_reset),
+        .i_src          (o_bus_gnt),
+        .i_wb_cyc       (arb_wb_cyc & mbox_sel),
+        .i_wb_stb       (arb_wb_stb & mbox_sel),
+        .i_wb_wen       (o_wb_we),
+        .i_wb_sel       (4'(o_wb_sel >> {WB_64 && o_wb_adr[2], 2'd0})),
+        .i_wb_dat       (wb_lane_dat(64'(o_wb_dat), WB_64 && o_wb_adr[2])),
+        .i_wb_adr       ({{(32-MBOX_WDT){1'd0}}, o_wb_adr[MBOX_WDT-1:0]}),
+        .o_wb_ack       (mbox_wb_ack),
+        .o_wb_dat       (mbox_wb_dat),
+        .o_irq          (mbox_irq)
+);
+
+endmodule : zap_cluster
+
+// ----------------------------------------------------------------------------
+// END OF FILE
+// ----------------------------------------------------------------------------
@@ -38,12 +38,18 @@ module zap_core #(
         // For CP15 purposes. Actual conversion is handled at a higher module.
         parameter logic BE_32_ENABLE            = 1'd0,
 
+        // Core ID. For CP15 purposes.
+        parameter logic [7:0]  CORE_ID          = 8'd0,
+
         // Number of branch predictor entries.
         parameter logic [31:0] BP_ENTRIES       = 32'd1024,
 
         // Depth of FIFO.
         parameter logic [31:0] FIFO_DEPTH       = 32'd4,
 
+        // Loop buffer depth. 0 disables the loop buffer.
+        parameter logic [31:0] LOOP_BUFFER_DEPTH = 32'd0,
+
         // RAS depth.
         parameter logic [31:0] RAS_DEPTH        = 32'd4,
 
@@ -137,14 +143,21 @@ output logic                             o_dcache_inv,
 output logic                             o_icache_inv,
 output logic                             o_dcache_clean,
 output logic                             o_icache_clean,
+output logic                             o_dcache_range,
+output logic      [31:0]                 o_dcache_range_start,
+output logic      [31:0]                 o_dcache_range_end,
+output logic                             o_dcache_range_clean,
+output logic                             o_dcache_range_inv,
 output logic                             o_dtlb_inv,
 output logic                             o_itlb_inv,
 output logic                             o_dcache_en,
 output logic                             o_icache_en,
+output logic                             o_dcache_stream,
 input   logic                            i_dcache_inv_done,
 input   logic                            i_icache_inv_done,
 input   logic                            i_dcache_clean_done,
 input   logic                            i_icache_clean_done,
+input   logic                            i_dcache_range_done,
 input   logic                            i_icache_err2,
 input   logic                            i_dcache_err2,
 
@@ -205,6 +218,15 @@ logic [31:0]                     fetch_pc_plus_8_ff; // PC + 8 generated from th
 logic [1:0]                      fetch_bp_state;
 logic [32:0]                     fetch_pred;
 
+// Loop buffer.
+logic                            lb_lock;
+logic [31:0]                     lb_pc_ff;
+logic [31:0]                     lb_pc_nxt;
+logic [31:0]                     lb_instruction;
+logic                            lb_valid;
+logic [1:0]                      lb_taken;
+logic [32:0]                     lb_pred;
+
 // FIFO.
 logic [31:0]                     fifo_pc_plus_8;
 logic                            fifo_valid;
@@ -591,12 +613,14 @@ zap_fetch_main u_zap_fetch_main (
         .i_clear_from_writeback         (clear_from_writeback),
         .i_clear_from_decode            (clear_from_decode),
         .i_clear_from_alu               (clear_from_alu),
-        .i_taken                        (wb_taken),
-        .i_pred                         (wb_pred),
-        .i_pc_ff                        (o_instr_wb_adr),
-        .i_instruction                  (i_instr_wb_dat),
-        .i_valid                        (i_icache_err2  ? 1'd0  : instr_valid),
-        .i_instr_abort                  (i_icache_err2  ? 1'd0  : i_instr_wb_err),
+        .i_taken                        (lb_lock ? lb_taken       : wb_taken),
+        .i_pred                         (lb_lock ? lb_pred        : wb_pred),
+        .i_pc_ff                        (lb_lock ? lb_pc_ff       : o_instr_wb_adr),
+        .i_instruction                  (lb_lock ? lb_instruction : i_instr_wb_dat),
+        .i_valid                        (lb_lock ? lb_valid       :
+                                         i_icache_err2  ? 1'd0  : instr_valid),
+        .i_instr_abort                  (lb_lock ? 1'd0           :
+                                         i_icache_err2  ? 1'd0  : i_instr_wb_err),
         .i_cpsr_ff_t                    (alu_flags_ff[T]),
 
         // Output.
@@ -611,6 +635,49 @@ zap_fetch_main u_zap_fetch_main (
         .o_pred                         (fetch_pred)
 );
 
+//
+// Loop buffer. Captures short backward branch loops and replays them
+// into the fetch stage without going to the I-cache.
+//
+if ( LOOP_BUFFER_DEPTH != 0 )
+begin : l_loop_buffer
+        zap_loop_buffer #( .DEPTH(LOOP_BUFFER_DEPTH) ) u_zap_loop_buffer (
+                .i_clk                  (i_clk),
+                .i_reset                (reset),
+                .i_code_stall           (code_stall),
+                .i_clear_from_writeback (clear_from_writeback),
+                .i_clear_from_alu       (clear_from_alu),
+                .i_clear_from_decode    (clear_from_decode),
+                .i_icache_inv           (o_icache_inv),
+                .i_itlb_inv             (o_itlb_inv),
+                .i_clear_btb            (predecode_clear_btb),
+                .i_cpsr_ff_t            (alu_flags_ff[T]),
+                .i_pc_ff                (o_instr_wb_adr),
+                .i_instruction          (i_instr_wb_dat),
+                .i_valid                (i_icache_err2 ? 1'd0 : instr_valid),
+                .i_instr_abort          (i_instr_wb_err),
+                .i_taken                (wb_taken),
+                .i_pred                 (wb_pred),
+                .o_lock                 (lb_lock),
+                .o_pc_ff                (lb_pc_ff),
+                .o_pc_nxt               (lb_pc_nxt),
+                .o_instruction          (lb_instruction),
+                .o_valid                (lb_valid),
+                .o_taken                (lb_taken),
+                .o_pred                 (lb_pred)
+        );
+end : l_loop_buffer
+else
+begin : l_no_loop_buffer
+        assign lb_lock        = 1'd0;
+        assign lb_pc_ff       = '0;
+        assign lb_pc_nxt      = '0;
+        assign lb_instruction = '0;
+        assign lb_valid       = 1'd0;
+        assign lb_taken       = '0;
+        assign lb_pred        = '0;
+end : l_no_loop_buffer
+
 //
 // Pre-fetch buffer.
 //
@@ -1504,6 +1571,9 @@ u_zap_writeback
         .i_pc_from_alu          (pc_from_alu),
         .i_clear_from_icache    (i_icache_err2),
 
+        .i_loop_lock            (lb_lock),
+        .i_pc_from_loop         (lb_pc_nxt),
+
         .i_mode16               (alu_flags_ff[T]),    // To indicate mode16 state.
 
         .i_clear_from_decode    (clear_from_decode),
@@ -1572,7 +1642,8 @@ zap_cp15_cb #(
 .DATA_CACHE_SIZE(DATA_CACHE_SIZE),
 .CODE_CACHE_SIZE(CODE_CACHE_SIZE),
 .DATA_CACHE_LINE(DATA_CACHE_LINE),
-.CODE_CACHE_LINE(CODE_CACHE_LINE)
+.CODE_CACHE_LINE(CODE_CACHE_LINE),
+.CORE_ID(CORE_ID)
 ) u_zap_cp15_cb (
         .i_clk                  (i_clk),
         .i_reset                (i_reset),
@@ -1598,14 +1669,21 @@ zap_cp15_cb #(
         .o_icache_inv           (o_icache_inv),
         .o_dcache_clean         (o_dcache_clean),
         .o_icache_clean         (o_icache_clean),
+        .o_dcache_range         (o_dcache_range),
+        .o_dcache_range_start   (o_dcache_range_start),
+        .o_dcache_range_end     (o_dcache_range_end),
+        .o_dcache_range_clean   (o_dcache_range_clean),
+        .o_dcache_range_inv     (o_dcache_range_inv),
         .o_dtlb_inv             (o_dtlb_inv),
         .o_itlb_inv             (o_itlb_inv),
         .o_dcache_en            (o_dcache_en),
         .o_icache_en            (o_icache_en),
+        .o_dcache_stream        (o_dcache_stream),
         .i_dcache_inv_done      (i_dcache_inv_done),
         .i_icache_inv_done      (i_icache_inv_done),
         .i_dcache_clean_done    (i_dcache_clean_done),
-        .i_icache_clean_done    (i_icache_clean_done)
+        .i_icache_clean_done    (i_icache_clean_done),
+        .i_dcache_range_done    (i_dcache_range_done)
 );
 
 // Readout of CPU mode. Useful for debugging.
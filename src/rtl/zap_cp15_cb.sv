@@ -35,6 +35,7 @@ module zap_cp15_cb
         parameter logic [31:0] DATA_CACHE_LINE   = 32'd64,
         parameter logic [31:0] CODE_CACHE_SIZE   = 32'd1024,
         parameter logic [31:0] DATA_CACHE_SIZE   = 32'd1024,
+        parameter logic [7:0]  CORE_ID           = 8'd0,
 
         localparam type t_cp_instruction =
                         struct packed   {
@@ -128,6 +129,14 @@ module zap_cp15_cb
         output logic                              o_dcache_clean,
         output logic                              o_icache_clean,
 
+        // Cache clean/invalidate by VA range. Range is held stable while
+        // the request is active. Both start and end are inclusive.
+        output logic                              o_dcache_range,
+        output logic      [31:0]                  o_dcache_range_start,
+        output logic      [31:0]                  o_dcache_range_end,
+        output logic                              o_dcache_range_clean,
+        output logic                              o_dcache_range_inv,
+
         // TLB invalidate signal - single cycle.
         output logic                              o_dtlb_inv,
         output logic                              o_itlb_inv,
@@ -136,13 +145,22 @@ module zap_cp15_cb
         output logic                              o_dcache_en,
         output logic                              o_icache_en,
 
+        // Streaming store enable. A word store to the first word of a
+        // line that misses starts a stream. Stores to the line are gathered
+        // without a line fill. A full line is allocated dirty. A partial
+        // line is written out as one SEL masked burst and not allocated.
+        output logic                              o_dcache_stream,
+
         // From MMU. Specify that cache invalidation is done.
         input   logic                            i_dcache_inv_done,
         input   logic                            i_icache_inv_done,
 
         // From MMU. Specify that cache clean is done.
         input   logic                            i_dcache_clean_done,
-        input   logic                            i_icache_clean_done
+        input   logic                            i_icache_clean_done,
+
+        // From MMU. Specify that range operation is done.
+        input   logic                            i_dcache_range_done
 );
 
 `include "zap_localparams.svh"
@@ -155,6 +173,7 @@ module zap_cp15_cb
 
 logic [31:0] r [13:0];// Coprocessor registers. R7, R8 is write-only.
 logic [3:0]    state; // State variable.
+logic [31:0] range_start, range_end; // Range registers. Write-only.
 
 // ---------------------------------------------
 // Localparams
@@ -173,6 +192,7 @@ localparam [3:0] CLR_I_CACHE          = 8;
 localparam [3:0] CLEAN_D_CACHE        = 9;
 localparam [3:0] CLFLUSH_ID_CACHE     = 10;
 localparam [3:0] CLFLUSH_D_CACHE      = 11;
+localparam [3:0] RANGE_D_CACHE        = 12;
 
 // Register numbers.
 localparam [3:0] FSR_REG              = 5;
@@ -188,6 +208,14 @@ localparam [6:0] CASE_CLEAN_ID_CACHE       = 7'b000_1011;
 localparam [6:0] CASE_CLEAN_D_CACHE        = 7'b000_1010;
 localparam [6:0] CASE_CLFLUSH_ID_CACHE     = 7'b000_1111;
 localparam [6:0] CASE_CLFLUSH_D_CACHE      = 7'b000_1110;
+localparam [6:0] CASE_INV_D_LINE           = 7'b001_0110;
+localparam [6:0] CASE_CLEAN_D_LINE         = 7'b001_1010;
+localparam [6:0] CASE_CLFLUSH_D_LINE       = 7'b001_1110;
+localparam [6:0] CASE_SET_RANGE_START      = 7'b100_1100;
+localparam [6:0] CASE_SET_RANGE_END        = 7'b101_1100;
+localparam [6:0] CASE_INV_D_RANGE          = 7'b101_0110;
+localparam [6:0] CASE_CLEAN_D_RANGE        = 7'b101_1010;
+localparam [6:0] CASE_CLFLUSH_D_RANGE      = 7'b101_1110;
 localparam [6:0] CASE_FLUSH_ID_TLB         = 7'b00?_0111;
 localparam [6:0] CASE_FLUSH_I_TLB          = 7'b00?_0101;
 localparam [6:0] CASE_FLUSH_D_TLB          = 7'b00?_0110;
@@ -271,6 +299,7 @@ begin
         begin
                 o_dcache_en <= 1'd0;
                 o_icache_en <= 1'd0;
+                o_dcache_stream <= 1'd0;
                 o_mmu_en    <= 1'd0;
                 o_pid       <= 8'd0;
                 o_l4_enable <= CP15_L4_DEFAULT;
@@ -279,6 +308,7 @@ begin
         begin
                 o_dcache_en <= r[1][2];              // Data cache enable.
                 o_icache_en <= r[1][12];             // Instruction cache enable.
+                o_dcache_stream <= r[1][10];         // Streaming store enable.
                 o_mmu_en    <= r[1][0];              // MMU enable.
                 o_pid       <= {1'd0, r[13][31:25]}; // PID register.
                 o_l4_enable <= r[1][14];             // 1 for v4T compatibility.
@@ -303,6 +333,13 @@ begin
                 o_icache_inv   <= 1'd0;
                 o_dcache_clean <= 1'd0;
                 o_icache_clean <= 1'd0;
+                o_dcache_range <= 1'd0;
+                o_dcache_range_start <= 32'd0;
+                o_dcache_range_end   <= 32'd0;
+                o_dcache_range_clean <= 1'd0;
+                o_dcache_range_inv   <= 1'd0;
+                range_start    <= 32'd0;
+                range_end      <= 32'd0;
                 o_dtlb_inv     <= 1'd0;
                 o_itlb_inv     <= 1'd0;
                 o_reg_en       <= 1'd0;
@@ -337,6 +374,7 @@ begin
                 o_icache_inv    <= 1'd0;
                 o_icache_clean  <= 1'd0;
                 o_dcache_clean  <= 1'd0;
+                o_dcache_range  <= 1'd0;
                 o_reg_en        <= 1'd0;
                 o_cp_done       <= 1'd0;
 
@@ -480,6 +518,44 @@ begin
                                         state          <= CLFLUSH_ID_CACHE;
                                 end
 
+                                CASE_INV_D_LINE,
+                                CASE_CLEAN_D_LINE,
+                                CASE_CLFLUSH_D_LINE:
+                                begin
+                                        // Single line. Range is [Rd, Rd].
+                                        o_dcache_range       <= 1'd1;
+                                        o_dcache_range_start <= i_reg_rd_data;
+                                        o_dcache_range_end   <= i_reg_rd_data;
+                                        o_dcache_range_clean <= i_cp_word.ZAP_CRM[3];
+                                        o_dcache_range_inv   <= i_cp_word.ZAP_CRM[2];
+                                        state                <= RANGE_D_CACHE;
+                                end
+
+                                CASE_INV_D_RANGE,
+                                CASE_CLEAN_D_RANGE,
+                                CASE_CLFLUSH_D_RANGE:
+                                begin
+                                        // Range set up earlier through c12.
+                                        o_dcache_range       <= 1'd1;
+                                        o_dcache_range_start <= range_start;
+                                        o_dcache_range_end   <= range_end;
+                                        o_dcache_range_clean <= i_cp_word.ZAP_CRM[3];
+                                        o_dcache_range_inv   <= i_cp_word.ZAP_CRM[2];
+                                        state                <= RANGE_D_CACHE;
+                                end
+
+                                CASE_SET_RANGE_START:
+                                begin
+                                        // Record range start. No cache operation.
+                                        range_start <= i_reg_rd_data;
+                                end
+
+                                CASE_SET_RANGE_END:
+                                begin
+                                        // Record range end. No cache operation.
+                                        range_end <= i_reg_rd_data;
+                                end
+
                                 default:
                                 begin
                                         // Clean D cache.
@@ -518,6 +594,17 @@ begin
                         end
                 end
 
+                RANGE_D_CACHE: // Clean and/or invalidate a range of lines.
+                begin
+                        o_dcache_range <= 1'd1;
+
+                        if ( i_dcache_range_done )
+                        begin
+                                o_dcache_range <= 1'd0;
+                                state          <= DONE;
+                        end
+                end
+
                 CLR_D_CACHE, CLR_D_CACHE_AND: // Clear data cache.
                 begin
                         o_dcache_inv <= 1'd1;
@@ -561,7 +648,9 @@ begin
                                                 o_reg_en        <= 1'd1;
                                                 o_reg_wr_index  <= translate( {1'd0, i_cp_word[15:12]}, i_cpsr[ZAP_CPSR_MODE:0] );
                                                 o_reg_wr_data   <= i_cp_word[19:16] == 0 && i_cp_word.ZAP_OPCODE_2 == 1 ?
-                                                                   CACHE_TYPE_WORD : r[ i_cp_word[19:16] ];
+                                                                   CACHE_TYPE_WORD :
+                                                                   i_cp_word[19:16] == 0 && i_cp_word.ZAP_OPCODE_2 == 5 ?
+                                                                   {24'd0, CORE_ID} : r[ i_cp_word[19:16] ];
                                                 state           <= DONE;
                                         end
                                         else // Store from CPU register.
@@ -590,6 +679,13 @@ begin
                         o_icache_inv   <= 'x; //
                         o_dcache_clean <= 'x; //
                         o_icache_clean <= 'x; //
+                        o_dcache_range <= 'x; //
+                        o_dcache_range_start <= 'x; //
+                        o_dcache_range_end   <= 'x; //
+                        o_dcache_range_clean <= 'x; //
+                        o_dcache_range_inv   <= 'x; //
+                        range_start    <= 'x; //
+                        range_end      <= 'x; //
                         o_dtlb_inv     <= 'x; //
                         o_itlb_inv     <= 'x; //
                         o_reg_en       <= 'x; //
@@ -623,6 +719,7 @@ begin
                         r[1][2]  <= 1'd0;
                         r[1][12] <= 1'd0;
                         r[1][0]  <= 1'd0;
+                        r[1][10] <= 1'd0;
                 end
         end
 end
@@ -30,7 +30,9 @@ parameter logic [31:0] SECTION_TLB_ENTRIES    = 32'd8,
 parameter logic [31:0] FPAGE_TLB_ENTRIES      = 32'd8,
 parameter logic [31:0] CACHE_LINE             = 32'd8,
 parameter logic        BE_32_ENABLE           = 1'd0,
-parameter logic [31:0] CPSR_MODE              = 32'd4
+parameter logic        BG_WRITEBACK           = 1'd0,
+parameter logic [31:0] CPSR_MODE              = 32'd4,
+parameter logic [31:0] WB_DATA_WIDTH          = 32'd32 // 32 or 64.
 
 )
 (
@@ -73,11 +75,20 @@ output  logic [63:0]     o_reg_idx,
 // MMU controls from/to processor.
 input   logic            i_mmu_en,
 input   logic            i_cache_en,
+input   logic            i_cache_stream,
 input   logic            i_cache_inv_req,
 input   logic            i_cache_clean_req,
 output logic             o_cache_inv_done,
 output  logic            o_cache_clean_done,
 
+// Range clean/invalidate from/to processor.
+input   logic            i_cache_range_req,
+input   logic [31:0]     i_cache_range_start,
+input   logic [31:0]     i_cache_range_end,
+input   logic            i_cache_range_clean,
+input   logic            i_cache_range_inv,
+output  logic            o_cache_range_done,
+
 input   logic [CPSR_MODE:0]    i_cpsr,
 input   logic [1:0]            i_sr,
 input   logic [31:0]           i_baddr,
@@ -85,31 +96,37 @@ input   logic [31:0]           i_dac_reg,
 input  logic                   i_tlb_inv,
 
 // Wishbone. Signals from all 4 modules are ORed.
-output logic              o_wb_stb, o_wb_stb_nxt,
-output logic              o_wb_cyc, o_wb_cyc_nxt,
-output logic              o_wb_wen, o_wb_wen_nxt,
-output logic  [3:0]       o_wb_sel, o_wb_sel_nxt,
-output logic  [31:0]      o_wb_dat, o_wb_dat_nxt,
-output logic  [31:0]      o_wb_adr, o_wb_adr_nxt,
-output logic  [2:0]       o_wb_cti, o_wb_cti_nxt,
-input  logic [31:0]       i_wb_dat,
-input  logic              i_wb_ack,
-input  logic              i_wb_err
+output logic                         o_wb_stb, o_wb_stb_nxt,
+output logic                         o_wb_cyc, o_wb_cyc_nxt,
+output logic                         o_wb_wen, o_wb_wen_nxt,
+output logic  [WB_DATA_WIDTH/8-1:0]  o_wb_sel, o_wb_sel_nxt,
+output logic  [WB_DATA_WIDTH-1:0]    o_wb_dat, o_wb_dat_nxt,
+output logic  [31:0]                 o_wb_adr, o_wb_adr_nxt,
+output logic  [2:0]                  o_wb_cti, o_wb_cti_nxt,
+input logic   [WB_DATA_WIDTH-1:0]    i_wb_dat,
+input logic                          i_wb_ack,
+input logic                          i_wb_err
 
 );
 
 `include "zap_defines.svh"
 `include "zap_localparams.svh"
+`include "zap_functions.svh"
 
 localparam [2:0] SELECT_CCH = 3'b001;
 localparam [2:0] SELECT_TAG = 3'b010;
 localparam [2:0] SELECT_TLB = 3'b100;
 
+localparam [31:0] WB_BYTES = WB_DATA_WIDTH / 32'd8;
+localparam [0:0]  WB_64    = WB_DATA_WIDTH == 32'd64;
+
 logic [2:0]                      wb_stb;
 logic [2:0]                      wb_cyc;
 logic [2:0]                      wb_wen;
-logic [3:0]                      wb_sel [2:0];
-logic [31:0]                     wb_dat [2:0];
+logic [WB_DATA_WIDTH/8-1:0]      wb_sel [2:0];
+logic [WB_DATA_WIDTH-1:0]        wb_dat [2:0];
+logic [3:0]                      tlb_wb_sel;
+logic [31:0]                     tlb_wb_dat;
 logic [31:0]                     wb_adr [2:0];
 logic [2:0]                      wb_cti [2:0];
 logic [31:0]                     tlb_phy_addr;
@@ -127,6 +144,8 @@ logic                            tr_cache_tag_valid;
 logic                            tr_cache_tag_dirty, cf_cache_tag_dirty;
 logic                            cf_cache_clean_req, cf_cache_inv_req;
 logic                            tr_cache_inv_done, tr_cache_clean_done;
+logic                            cf_cache_range_req, tr_cache_range_done;
+logic                            tr_bg_busy;
 logic [2:0]                      wb_ack;
 logic [2:0]                      state_ff, state_nxt;
 logic [31:0]                     cache_address;
@@ -142,7 +161,8 @@ assign wb_cti[2] = CTI_EOB;
 assign unused = |{wb_err[1]};
 
 // Basic cache FSM - serves as manager 0.
-zap_dcache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .BE_32_ENABLE(BE_32_ENABLE)) u_zap_cache_fsm (
+zap_dcache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .BE_32_ENABLE(BE_32_ENABLE),
+                 .WB_DATA_WIDTH(WB_DATA_WIDTH)) u_zap_cache_fsm (
         .i_clk                  (i_clk),
         .i_reset                (i_reset),
         .i_address              (i_address),
@@ -157,10 +177,14 @@ zap_dcache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .BE_32_ENABLE
         .o_fsr                  (o_fsr),
         .o_far                  (o_far),
         .i_cache_en             (i_cache_en),
+        .i_cache_stream         (i_cache_stream),
         .i_cache_inv            (i_cache_inv_req),
         .i_cache_clean          (i_cache_clean_req),
         .o_cache_inv_done       (o_cache_inv_done),
         .o_cache_clean_done     (o_cache_clean_done),
+        .i_cache_range          (i_cache_range_req),
+        .o_cache_range_done     (o_cache_range_done),
+        .i_bg_busy              (tr_bg_busy),
         .i_cache_line           (tr_cache_line),
         .i_cache_tag_dirty      (tr_cache_tag_dirty),
         .i_cache_tag            (tr_cache_tag),
@@ -174,6 +198,8 @@ zap_dcache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .BE_32_ENABLE
         .i_cache_clean_done     (tr_cache_clean_done),
         .o_cache_inv_req        (cf_cache_inv_req),
         .i_cache_inv_done       (tr_cache_inv_done),
+        .o_cache_range_req      (cf_cache_range_req),
+        .i_cache_range_done     (tr_cache_range_done),
         .i_phy_addr             (tlb_phy_addr),
         .i_fsr                  (tlb_fsr),
         .i_far                  (tlb_far),
@@ -212,7 +238,8 @@ zap_dcache_fsm #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .BE_32_ENABLE
 );
 
 // Cache Tag RAM - As a manager - this performs cache clean - manager 1.
-zap_cache_tag_ram #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE)) u_zap_cache_tag_ram     (
+zap_cache_tag_ram #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE), .BG_WRITEBACK(BG_WRITEBACK),
+                    .WB_DATA_WIDTH(WB_DATA_WIDTH)) u_zap_cache_tag_ram     (
         .i_clk                  (i_clk),
         .i_reset                (i_reset),
         .i_address_nxt          (i_address_nxt),
@@ -232,6 +259,15 @@ zap_cache_tag_ram #(.CACHE_SIZE(CACHE_SIZE), .CACHE_LINE(CACHE_LINE)) u_zap_cach
         .o_cache_inv_done       (tr_cache_inv_done),
         .i_cache_clean_req      (cf_cache_clean_req),
         .o_cache_clean_done     (tr_cache_clean_done),
+        .i_cache_range_req      (cf_cache_range_req),
+        .i_cache_range_start    (i_cache_range_start),
+        .i_cache_range_end      (i_cache_range_end),
+        .i_cache_range_clean    (i_cache_range_clean),
+        .i_cache_range_inv      (i_cache_range_inv),
+        .o_cache_range_done     (tr_cache_range_done),
+        .i_idle                 (idle),
+        .i_req                  (i_rd || i_wr),
+        .o_bg_busy              (tr_bg_busy),
 
         /* verilator lint_off PINCONNECTEMPTY */
         .o_wb_cyc_ff            (),
@@ -287,13 +323,17 @@ u_zap_tlb (
         .o_wb_cyc_nxt   (wb_cyc[2]),
         .o_wb_adr_nxt   (wb_adr[2]),
         .o_wb_wen_nxt   (wb_wen[2]),
-        .o_wb_sel_nxt   (wb_sel[2]),
-        .o_wb_dat_nxt   (wb_dat[2]),
-        .i_wb_dat       (i_wb_dat),
+        .o_wb_sel_nxt   (tlb_wb_sel),
+        .o_wb_dat_nxt   (tlb_wb_dat),
+        .i_wb_dat       (wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr[2])),
         .i_wb_ack       (wb_ack[2]),
         .i_wb_err       (wb_err[2])
 );
 
+// The TLB does 32-bit reads. Move them to the right lane on a 64-bit bus.
+assign wb_sel[2] = WB_BYTES'(wb_lane_sel(tlb_wb_sel, WB_64 && wb_adr[2][2]));
+assign wb_dat[2] = {(WB_DATA_WIDTH/32){tlb_wb_dat}};
+
 // Sequential Block
 always_ff @ ( posedge i_clk )
 begin
@@ -324,8 +364,9 @@ end
 // Next state logic.
 always_comb
 begin
-        // Change state only if strobe is inactive or strobe has just completed.
-        if ( !o_wb_stb || (o_wb_stb && (i_wb_ack || i_wb_err)) )
+        // Change state only if strobe is inactive or a cycle has just
+        // completed. Bursts are not broken up between managers.
+        if ( !o_wb_stb || (o_wb_stb && ((i_wb_ack && o_wb_cti == CTI_EOB) || i_wb_err)) )
         begin
                 casez({wb_cyc[2],wb_cyc[1],wb_cyc[0]})
                 3'b1?? : state_nxt = SELECT_TLB; // TLB.
@@ -26,7 +26,8 @@
 module zap_dcache_fsm   #(
         parameter logic [31:0] CACHE_SIZE    = 32'd1024,  // Bytes.
         parameter logic [31:0] CACHE_LINE    = 32'd8,
-        parameter logic        BE_32_ENABLE  = 1'd0
+        parameter logic        BE_32_ENABLE  = 1'd0,
+        parameter logic [31:0] WB_DATA_WIDTH = 32'd32     // 32 or 64.
 )
 
 // ----------------------------------------------
@@ -59,12 +60,20 @@ output  logic                      o_err2,
 
 // From/To CP15 unit
 input   logic                      i_cache_en,
+input   logic                      i_cache_stream, // Streaming stores.
 input   logic                      i_cache_inv,
 input   logic                      i_cache_clean,
 
 output  logic                       o_cache_inv_done,
 output  logic                       o_cache_clean_done,
 
+// Range clean/invalidate. Range is given directly to the tag RAM.
+input   logic                       i_cache_range,
+output  logic                       o_cache_range_done,
+
+// Background write back in progress. Accesses are replayed.
+input   logic                       i_bg_busy,
+
 // From/to cache.
 input   logic    [CACHE_LINE*8-1:0]     i_cache_line,
 
@@ -85,6 +94,9 @@ input   logic                       i_cache_clean_done,
 output  logic                       o_cache_inv_req,
 input   logic                       i_cache_inv_done,
 
+output  logic                       o_cache_range_req,
+input   logic                       i_cache_range_done,
+
 output logic [31:0]                 o_address,
 
 // From/to TLB unit
@@ -100,16 +112,16 @@ output  logic                      o_hold,
 output  logic                      o_idle,
 
 // Bus access ports, both NXT and FF.
-output  logic             o_wb_cyc_ff, o_wb_cyc_nxt,
-output  logic             o_wb_stb_ff, o_wb_stb_nxt,
-output  logic     [31:0]  o_wb_adr_ff, o_wb_adr_nxt,
-output  logic     [31:0]  o_wb_dat_ff, o_wb_dat_nxt,
-output  logic     [3:0]   o_wb_sel_ff, o_wb_sel_nxt,
-output  logic             o_wb_wen_ff, o_wb_wen_nxt,
-output  logic     [2:0]   o_wb_cti_ff, o_wb_cti_nxt,
-input   logic             i_wb_ack,
-input   logic    [31:0]   i_wb_dat,
-input   logic             i_wb_err
+output  logic                             o_wb_cyc_ff, o_wb_cyc_nxt,
+output  logic                             o_wb_stb_ff, o_wb_stb_nxt,
+output  logic     [31:0]                  o_wb_adr_ff, o_wb_adr_nxt,
+output  logic     [WB_DATA_WIDTH-1:0]     o_wb_dat_ff, o_wb_dat_nxt,
+output  logic     [WB_DATA_WIDTH/8-1:0]   o_wb_sel_ff, o_wb_sel_nxt,
+output  logic                             o_wb_wen_ff, o_wb_wen_nxt,
+output  logic     [2:0]                   o_wb_cti_ff, o_wb_cti_nxt,
+input   logic                             i_wb_ack,
+input   logic     [WB_DATA_WIDTH-1:0]     i_wb_dat,
+input   logic                             i_wb_err
 
 );
 
@@ -122,19 +134,28 @@ input   logic             i_wb_err
 `include "zap_functions.svh"
 
 // States. FSM is 1-hot.
-localparam [2:0] IDLE                 = 3'd0; // Resting state.
-localparam [2:0] UNCACHEABLE          = 3'd1; // Uncacheable access.
-localparam [2:0] UNCACHEABLE_PREPARE  = 3'd2; // Prepare uncacheable access.
-localparam [2:0] CLEAN_SINGLE         = 3'd3; // Ultimately cleans up cache line. Parent state
-localparam [2:0] FETCH_SINGLE         = 3'd4; // Ultimately validates cache line. Parent state
-localparam [2:0] INVALIDATE           = 3'd5; // Cache invalidate parent state
-localparam [2:0] CLEAN                = 3'd6; // Cache clean parent state
-localparam [2:0] UNLOCK_REG           = 3'd7; // Unlock register
-localparam [31:0] NUMBER_OF_STATES    = 32'd8;
-
-localparam [31:0] ADR_PAD              =  32'd32 - $clog2(CACHE_LINE/4) - 32'd1;
-localparam [31:0] ADR_PAD_MINUS_2      =  ADR_PAD - 32'd2;
+localparam [3:0] IDLE                 = 4'd0; // Resting state.
+localparam [3:0] UNCACHEABLE          = 4'd1; // Uncacheable access.
+localparam [3:0] UNCACHEABLE_PREPARE  = 4'd2; // Prepare uncacheable access.
+localparam [3:0] CLEAN_SINGLE         = 4'd3; // Ultimately cleans up cache line. Parent state
+localparam [3:0] FETCH_SINGLE         = 4'd4; // Ultimately validates cache line. Parent state
+localparam [3:0] INVALIDATE           = 4'd5; // Cache invalidate parent state
+localparam [3:0] CLEAN                = 4'd6; // Cache clean parent state
+localparam [3:0] UNLOCK_REG           = 4'd7; // Unlock register
+localparam [3:0] RANGE                = 4'd8; // Range clean/invalidate parent state
+localparam [3:0] STREAM               = 4'd9; // Gather streaming stores to a line
+localparam [3:0] STREAM_FLUSH         = 4'd10;// Write out a partly gathered line
+localparam [31:0] NUMBER_OF_STATES    = 32'd11;
+
+// Bus width. Lines are moved WB_BYTES at a time.
+localparam [31:0] WB_BYTES             =  WB_DATA_WIDTH / 32'd8;   // Bytes per beat.
+localparam [31:0] WB_WORDS             =  WB_DATA_WIDTH / 32'd32;  // Words per beat.
+localparam [31:0] BEATS                =  CACHE_LINE / WB_BYTES;   // Beats per line.
+localparam [0:0]  WB_64                =  WB_DATA_WIDTH == 32'd64;
+
+localparam [31:0] ADR_PAD              =  32'd32 - $clog2(BEATS) - 32'd1;
 localparam [31:0] LINE_PAD             = (CACHE_LINE * 32'd8) - 32'd32;
+localparam [31:0] WORD_WDT             =  $clog2(CACHE_LINE/4);
 
 // ----------------------------------------------------------------------------
 // Variables
@@ -150,9 +171,19 @@ logic                                     cache_clean_req_nxt,
                                           cache_clean_req_ff;
 logic                                     cache_inv_req_nxt,
                                           cache_inv_req_ff;
-logic [$clog2(CACHE_LINE/4):0]            adr_ctr_ff, adr_ctr_nxt; // Needs to take on 0,1,2,3, ... CACHE_LINE/4
+logic                                     cache_range_req_nxt,
+                                          cache_range_req_ff;
+logic [$clog2(BEATS):0]                   adr_ctr_ff, adr_ctr_nxt; // Needs to take on 0,1,2,3, ... BEATS
 logic                                     rhit, whit;
 
+// Streaming stores. Bytes of the line buffer written by the stream.
+logic [CACHE_LINE-1:0]                    sbm_ff, sbm_nxt;
+logic                                     stream_ff, stream_nxt;
+logic [3:0]                               stream_idle_ff, stream_idle_nxt;
+logic                                     stream_start, stream_hit;
+logic [CACHE_LINE*8-1:0]                  buf_line;
+logic [$clog2(BEATS):0]                   stream_last;
+
 // From/to processor
 logic    [31:0]                           address;
 logic                                     wr;
@@ -176,11 +207,47 @@ assign      unused = |{phy_addr[$clog2(CACHE_LINE)-1:0]};
 // Tie flops to the output
 assign o_cache_clean_req = cache_clean_req_ff; // Tie req flop to output.
 assign o_cache_inv_req   = cache_inv_req_ff;   // Tie inv flop to output.
+assign o_cache_range_req = cache_range_req_ff; // Tie range flop to output.
 
 // Alias
 assign cache_cmp   = (i_cache_tag[`ZAP_CACHE_TAG__TAG] == i_address[`ZAP_VA__CACHE_TAG]);
 assign cache_dirty = i_cache_tag_dirty;
 
+//
+// A full word store to the first word of a line that misses starts a stream.
+// The line is then gathered in the line buffer without a line fill. Other
+// stores to the same line join the stream.
+//
+assign stream_start = i_cache_stream && i_wr && !i_rd && (i_ben == 4'b1111) &&
+                      (i_address[$clog2(CACHE_LINE)-1:2] == '0);
+
+assign stream_hit   = i_wr && !i_rd && !i_fault && i_cache_en && i_cacheable &&
+                      (i_address[31:$clog2(CACHE_LINE)]  == address[31:$clog2(CACHE_LINE)]) &&
+                      (i_phy_addr[31:$clog2(CACHE_LINE)] == phy_addr[31:$clog2(CACHE_LINE)]);
+
+// Line buffer as a line.
+always_comb
+begin
+        for(int i=0;i<CACHE_LINE/4;i++)
+        begin
+                buf_line[i*32 +: 32] = buf_ff[i];
+        end
+end
+
+// Last beat of the line buffer that has bytes written by the stream.
+always_comb
+begin
+        stream_last = '0;
+
+        for(int i=0;i<BEATS;i++)
+        begin
+                if ( |sbm_ff[i*WB_BYTES +: WB_BYTES] )
+                begin
+                        stream_last = ($clog2(BEATS)+1)'(i);
+                end
+        end
+end
+
 // Buffers
 always_ff @ ( posedge i_clk )
 begin
@@ -229,8 +296,11 @@ begin
                 o_wb_adr_ff             <= 'x;
                 cache_clean_req_ff      <= 0;
                 cache_inv_req_ff        <= 0;
+                cache_range_req_ff      <= 0;
                 adr_ctr_ff              <= 0;
                 lock_ff                 <= 64'd0;
+                stream_ff               <= 0;
+                stream_idle_ff          <= 0;
 
                 // STATE - Drive state to 000...0001.
                 state_ff                <= 0;       // Rest of bits
@@ -250,8 +320,11 @@ begin
                 o_wb_adr_ff             <= o_wb_adr_nxt;
                 cache_clean_req_ff      <= cache_clean_req_nxt;
                 cache_inv_req_ff        <= cache_inv_req_nxt;
+                cache_range_req_ff      <= cache_range_req_nxt;
                 adr_ctr_ff              <= adr_ctr_nxt;
                 lock_ff                 <= lock_nxt;
+                stream_ff               <= stream_nxt;
+                stream_idle_ff          <= stream_idle_nxt;
 
                 // STATE
                 state_ff                <= state_nxt;
@@ -264,6 +337,8 @@ begin
         begin
                 buf_ff[i] <= buf_nxt[i];
         end
+
+        sbm_ff <= sbm_nxt;
 end
 
 // Idle indication
@@ -281,6 +356,7 @@ begin:next_state_logic
        // =======================================================
 
        logic [$clog2(CACHE_LINE/4)-1:0] tmp;
+       logic [$clog2(CACHE_LINE/4)-1:0] widx;
 
         // =====================================================
         // Default values section
@@ -288,6 +364,7 @@ begin:next_state_logic
         // =====================================================
 
         tmp                     = {($clog2(CACHE_LINE/4)){1'd0}};
+        widx                    = {($clog2(CACHE_LINE/4)){1'd0}};
         state_nxt               = state_ff;
         adr_ctr_nxt             = adr_ctr_ff;
         o_wb_cyc_nxt            = o_wb_cyc_ff;
@@ -300,12 +377,17 @@ begin:next_state_logic
         o_wb_sel_nxt            = o_wb_sel_ff;
         cache_clean_req_nxt     = cache_clean_req_ff;
         cache_inv_req_nxt       = cache_clean_req_ff;
+        cache_range_req_nxt     = cache_range_req_ff;
+        sbm_nxt                 = sbm_ff;
+        stream_nxt              = stream_ff;
+        stream_idle_nxt         = stream_idle_ff;
         o_lock                  = lock_ff;
         o_fsr                   = 0;
         o_far                   = 0;
         o_cache_tag             = 0;
         o_cache_inv_done        = 0;
         o_cache_clean_done      = 0;
+        o_cache_range_done      = 0;
         o_cache_tag_dirty       = 0;
         o_cache_tag_wr_en       = 0;
         o_cache_line            = 0;
@@ -332,13 +414,15 @@ begin:next_state_logic
 
         if(state_ff[UNCACHEABLE])
         begin
+            // On a 64-bit bus, pick the 32-bit lane that was accessed.
             if ( BE_32_ENABLE )
             begin
-                o_dat = be_32(i_wb_dat, o_wb_sel_ff);
+                o_dat = be_32(wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr_ff[2]),
+                              4'(o_wb_sel_ff >> {WB_64 && o_wb_adr_ff[2], 2'd0}));
             end
             else
             begin
-                o_dat = i_wb_dat;
+                o_dat = wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr_ff[2]);
             end
         end
         else
@@ -369,6 +453,12 @@ begin:next_state_logic
                         state_nxt[IDLE] = 1'd0;
                         state_nxt[CLEAN] = 1'd1;
                 end
+                else if ( i_cache_range )
+                begin
+                        o_ack     = 1'd0;
+                        state_nxt[IDLE] = 1'd0;
+                        state_nxt[RANGE] = 1'd1;
+                end
                 else if ( !i_rd && !i_wr )
                 begin
                         o_ack = 1'd1;
@@ -381,7 +471,7 @@ begin:next_state_logic
                         o_fsr = i_fsr;
                         o_far = i_far;
                 end
-                else if ( i_busy )
+                else if ( i_busy || i_bg_busy )
                 begin
                         // Wait it out - this is what err2 is for.
                         o_err2 = 1'd1;
@@ -402,15 +492,16 @@ begin:next_state_logic
                                 o_wb_adr_nxt    = i_address;
                                 o_wb_wen_nxt    = i_wr;
                                 o_wb_cti_nxt    = CTI_EOB;
-                                o_wb_dat_nxt    = i_din;
+                                o_wb_dat_nxt    = {WB_WORDS{i_din}};
 
                                 if ( BE_32_ENABLE )
                                 begin
-                                        o_wb_sel_nxt = be_sel_32(i_ben);
+                                        o_wb_sel_nxt = WB_BYTES'(wb_lane_sel(be_sel_32(i_ben),
+                                                       WB_64 && i_address[2]));
                                 end
                                 else
                                 begin
-                                        o_wb_sel_nxt = i_ben;
+                                        o_wb_sel_nxt = WB_BYTES'(wb_lane_sel(i_ben, WB_64 && i_address[2]));
                                 end
                         end
                         else if ( i_cacheable )
@@ -458,6 +549,17 @@ begin:next_state_logic
                                                 o_err2    = lock_ff [i_reg_idx_bin];
                                         end
 
+                                        // Start a stream. Take the store.
+                                        stream_nxt      = stream_start;
+                                        stream_idle_nxt = 4'd0;
+
+                                        if ( stream_start )
+                                        begin
+                                                tmp          = i_address[$clog2(CACHE_LINE)-1:2];
+                                                buf_nxt[tmp] = i_din;
+                                                sbm_nxt      = ben_comp(tmp, i_ben);
+                                        end
+
                                         if ( cache_dirty )
                                         begin
                                                 // Set up counter
@@ -467,6 +569,12 @@ begin:next_state_logic
                                                 state_nxt[IDLE] = 1'd0;
                                                 state_nxt[CLEAN_SINGLE] = 1'd1;
                                         end
+                                        else if ( stream_start )
+                                        begin
+                                                // Gather the line. No fetch.
+                                                state_nxt[IDLE]   = 1'd0;
+                                                state_nxt[STREAM] = 1'd1;
+                                        end
                                         else if ( i_rd | i_wr )
                                         begin
                                                 // Set up counter
@@ -486,9 +594,24 @@ begin:next_state_logic
                                                 // Set up counter
                                                 adr_ctr_nxt = 0;
 
-                                                // Fetch a single cache line
-                                                state_nxt[IDLE] = 1'd0;
-                                                state_nxt[FETCH_SINGLE] = 1'd1;
+                                                if ( stream_start )
+                                                begin
+                                                        // Gather the line. No fetch.
+                                                        tmp             = i_address[$clog2(CACHE_LINE)-1:2];
+                                                        buf_nxt[tmp]    = i_din;
+                                                        sbm_nxt         = ben_comp(tmp, i_ben);
+                                                        stream_nxt      = 1'd1;
+                                                        stream_idle_nxt = 4'd0;
+
+                                                        state_nxt[IDLE]   = 1'd0;
+                                                        state_nxt[STREAM] = 1'd1;
+                                                end
+                                                else
+                                                begin
+                                                        // Fetch a single cache line
+                                                        state_nxt[IDLE] = 1'd0;
+                                                        state_nxt[FETCH_SINGLE] = 1'd1;
+                                                end
 
                                                 // Lock register on load
                                                 if ( i_rd )
@@ -523,15 +646,16 @@ begin:next_state_logic
                 o_wb_adr_nxt    = i_phy_addr;
                 o_wb_wen_nxt    = i_wr;
                 o_wb_cti_nxt    = CTI_EOB;
-                o_wb_dat_nxt    = i_din;
+                o_wb_dat_nxt    = {WB_WORDS{i_din}};
 
                 if ( BE_32_ENABLE )
                 begin
-                        o_wb_sel_nxt = be_sel_32(i_ben);
+                        o_wb_sel_nxt = WB_BYTES'(wb_lane_sel(be_sel_32(i_ben),
+                                       WB_64 && i_phy_addr[2]));
                 end
                 else
                 begin
-                        o_wb_sel_nxt = i_ben;
+                        o_wb_sel_nxt = WB_BYTES'(wb_lane_sel(i_ben, WB_64 && i_phy_addr[2]));
                 end
         end
 
@@ -566,10 +690,10 @@ begin:next_state_logic
                 end
 
                 // Generate address
-                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(CACHE_LINE/4) ){1'd0}}, 1'd1} :
-                                                                         {($clog2(CACHE_LINE/4)+1){1'd0}});
+                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(BEATS) ){1'd0}}, 1'd1} :
+                                                                         {($clog2(BEATS)+1){1'd0}});
 
-                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= ((CACHE_LINE/4) - 1) )
+                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= (BEATS - 1) )
                 begin
                         // Sync up with memory. Use PA in cache tag itself.
                         o_wb_cyc_nxt = 1'd1;
@@ -577,9 +701,9 @@ begin:next_state_logic
                         o_wb_wen_nxt = 1'd1;
                         o_wb_dat_nxt = clean_single_d (cache_line, adr_ctr_nxt);
                         o_wb_adr_nxt = {cache_tag[`ZAP_CACHE_TAG__PA], {$clog2(CACHE_LINE){1'd0}}} +
-                                       ({{ADR_PAD_MINUS_2{1'd0}}, adr_ctr_nxt, 2'd0});
-                       o_wb_cti_nxt =  {{ADR_PAD{1'd0}},adr_ctr_nxt} != ((CACHE_LINE/4) - 1) ? CTI_BURST : CTI_EOB;
-                       o_wb_sel_nxt =  4'b1111;
+                                       ({{ADR_PAD{1'd0}}, adr_ctr_nxt} * WB_BYTES);
+                       o_wb_cti_nxt =  {{ADR_PAD{1'd0}},adr_ctr_nxt} != (BEATS - 1) ? CTI_BURST : CTI_EOB;
+                       o_wb_sel_nxt =  {WB_BYTES{1'd1}};
                 end
                 else
                 begin
@@ -588,8 +712,10 @@ begin:next_state_logic
 
                         adr_ctr_nxt = 0;
 
+                        // Streams do not need the line.
                         state_nxt[CLEAN_SINGLE] = 1'd0;
-                        state_nxt[FETCH_SINGLE] = 1'd1;
+                        state_nxt[FETCH_SINGLE] = !stream_ff;
+                        state_nxt[STREAM]       =  stream_ff;
 
                         // Update tag. Remove dirty bit.
                         o_cache_tag_wr_en                      = 1'd1; // Implicitly sets valid (redundant).
@@ -610,13 +736,15 @@ begin:next_state_logic
                 end
 
                 // Generate address
-                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(CACHE_LINE/4) ){1'd0}}, 1'd1} :
-                                                                         {($clog2(CACHE_LINE/4)+1){1'd0}}) ;
+                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(BEATS) ){1'd0}}, 1'd1} :
+                                                                         {($clog2(BEATS)+1){1'd0}}) ;
 
-                // Write to buffer
-                buf_nxt[adr_ctr_ff[$clog2(CACHE_LINE/4)-1:0]] = (i_wb_ack|i_wb_err) ?
-                                                                i_wb_dat :
-                                                                buf_ff[adr_ctr_ff[$clog2(CACHE_LINE/4)-1:0]];
+                // Write to buffer. Each beat carries WB_WORDS words.
+                for(int i=0;i<WB_WORDS;i++)
+                begin
+                        widx          = WORD_WDT'(({{ADR_PAD{1'd0}}, adr_ctr_ff} * WB_WORDS) + i);
+                        buf_nxt[widx] = (i_wb_ack|i_wb_err) ? i_wb_dat[i*32 +: 32] : buf_ff[widx];
+                end
 
                 // Manipulate buffer as needed
                 if ( wr )
@@ -629,13 +757,13 @@ begin:next_state_logic
                         buf_nxt[tmp][31:24] = ben[3] ? din[31:24] : buf_nxt[tmp][31:24];
                 end
 
-                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= (CACHE_LINE/4) - 1 )
+                if ( {{ADR_PAD{1'd0}}, adr_ctr_nxt} <= BEATS - 1 )
                 begin
 
                         // Fetch line from memory
                         `zap_wb_prpr_read(
-                                     {phy_addr[31:$clog2(CACHE_LINE)], {$clog2(CACHE_LINE){1'd0}}} + (adr_ctr_nxt * (32/8)),
-                                     ({{ADR_PAD{1'd0}}, adr_ctr_nxt} != CACHE_LINE/4 - 1) ? CTI_BURST : CTI_EOB);
+                                     {phy_addr[31:$clog2(CACHE_LINE)], {$clog2(CACHE_LINE){1'd0}}} + (adr_ctr_nxt * WB_BYTES),
+                                     ({{ADR_PAD{1'd0}}, adr_ctr_nxt} != BEATS - 1) ? CTI_BURST : CTI_EOB);
                 end
                 else
                 begin:blk12
@@ -746,6 +874,126 @@ begin:next_state_logic
                 end
         end
 
+        state_ff[RANGE]:  // Clean/invalidate a range of lines
+        begin
+                cache_range_req_nxt = 1'd1;
+                cache_clean_req_nxt = 1'd0;
+                cache_inv_req_nxt   = 1'd0;
+
+                if ( i_cache_range_done )
+                begin
+                        cache_range_req_nxt  = 1'd0;
+
+                        state_nxt[RANGE]     = 1'd0;
+                        state_nxt[IDLE]      = 1'd1;
+
+                        o_cache_range_done   = 1'd1;
+                end
+        end
+
+        state_ff[STREAM]: // Gather stores to the line. No line fill.
+        begin
+                o_ack = 1'd1;
+
+                if ( i_cache_inv || i_cache_clean || i_cache_range || (&stream_idle_ff) )
+                begin
+                        // Give up. Write out what we have.
+                        o_err2      = i_rd || i_wr ? 1'd1 : 1'd0;
+                        adr_ctr_nxt = 0;
+
+                        state_nxt[STREAM]       = 1'd0;
+                        state_nxt[STREAM_FLUSH] = 1'd1;
+                end
+                else if ( !i_rd && !i_wr )
+                begin
+                        stream_idle_nxt = stream_idle_ff + 4'd1;
+                end
+                else if ( i_busy )
+                begin
+                        // Wait it out.
+                        o_err2 = 1'd1;
+                end
+                else if ( stream_hit )
+                begin
+                        stream_idle_nxt = 4'd0;
+
+                        tmp = i_address[$clog2(CACHE_LINE)-1:2];
+
+                        buf_nxt[tmp][7:0]   = i_ben[0] ? i_din[7:0]   : buf_ff[tmp][7:0];
+                        buf_nxt[tmp][15:8]  = i_ben[1] ? i_din[15:8]  : buf_ff[tmp][15:8];
+                        buf_nxt[tmp][23:16] = i_ben[2] ? i_din[23:16] : buf_ff[tmp][23:16];
+                        buf_nxt[tmp][31:24] = i_ben[3] ? i_din[31:24] : buf_ff[tmp][31:24];
+
+                        sbm_nxt = sbm_ff | ben_comp(tmp, i_ben);
+
+                        if ( &sbm_nxt )
+                        begin:blk13
+                                // Whole line written. Allocate it dirty.
+                                o_cache_line = 0;
+
+                                for(int i=0;i<CACHE_LINE/4;i++)
+                                begin
+                                        o_cache_line = o_cache_line | ({{LINE_PAD{1'd0}},buf_nxt[i][31:0]} << (32 * i));
+                                end
+
+                                o_cache_line_ben  = {CACHE_LINE{1'd1}};
+
+                                o_cache_tag_wr_en                = 1'd1;
+                                o_cache_tag[`ZAP_CACHE_TAG__TAG] = address[`ZAP_VA__CACHE_TAG];
+                                o_cache_tag[`ZAP_CACHE_TAG__PA]  = phy_addr[31:$clog2(CACHE_LINE)];
+                                o_cache_tag_dirty                = 1'd1;
+
+                                stream_nxt = 1'd0;
+
+                                state_nxt[STREAM] = 1'd0;
+                                state_nxt[IDLE]   = 1'd1;
+                        end
+                end
+                else
+                begin
+                        // Not part of the stream. Replay it after the write out.
+                        o_err2      = 1'd1;
+                        adr_ctr_nxt = 0;
+
+                        state_nxt[STREAM]       = 1'd0;
+                        state_nxt[STREAM_FLUSH] = 1'd1;
+                end
+        end
+
+        state_ff[STREAM_FLUSH]: // Write out the gathered bytes. The line is not allocated.
+        begin
+                o_ack  = 1'd1;
+                o_err2 = i_rd || i_wr ? 1'd1 : 1'd0;
+
+                // Generate address
+                adr_ctr_nxt = adr_ctr_ff + ((o_wb_stb_ff && (i_wb_ack|i_wb_err)) ? {{($clog2(BEATS) ){1'd0}}, 1'd1} :
+                                                                         {($clog2(BEATS)+1){1'd0}});
+
+                if ( adr_ctr_nxt <= stream_last )
+                begin
+                        // Burst out the line up to the last beat written. SEL
+                        // masks bytes not written. Line data is in bus order.
+                        o_wb_cyc_nxt = 1'd1;
+                        o_wb_stb_nxt = 1'd1;
+                        o_wb_wen_nxt = 1'd1;
+                        o_wb_dat_nxt = clean_single_d (buf_line, adr_ctr_nxt);
+                        o_wb_adr_nxt = {phy_addr[31:$clog2(CACHE_LINE)], {$clog2(CACHE_LINE){1'd0}}} +
+                                       ({{ADR_PAD{1'd0}}, adr_ctr_nxt} * WB_BYTES);
+                        o_wb_cti_nxt = adr_ctr_nxt != stream_last ? CTI_BURST : CTI_EOB;
+                        o_wb_sel_nxt = WB_BYTES'(sbm_ff >> ({{ADR_PAD{1'd0}}, adr_ctr_nxt} * WB_BYTES));
+                end
+                else
+                begin
+                        `zap_kill_access;
+
+                        adr_ctr_nxt = 0;
+                        stream_nxt  = 1'd0;
+
+                        state_nxt[STREAM_FLUSH] = 1'd0;
+                        state_nxt[IDLE]         = 1'd1;
+                end
+        end
+
         // ==========================================
         // Default Section (To simplify synth)
         // ==========================================
@@ -753,6 +1001,7 @@ begin:next_state_logic
         default:
         begin
                 tmp                     = 'x;
+                widx                    = 'x;
                 state_nxt               = 'x;
                 adr_ctr_nxt             = 'x;
                 o_wb_cyc_nxt            = 'x;
@@ -765,12 +1014,17 @@ begin:next_state_logic
                 o_wb_sel_nxt            = 'x;
                 cache_clean_req_nxt     = 'x;
                 cache_inv_req_nxt       = 'x;
+                cache_range_req_nxt     = 'x;
+                sbm_nxt                 = 'x;
+                stream_nxt              = 'x;
+                stream_idle_nxt         = 'x;
                 o_lock                  = 'x;
                 o_fsr                   = 'x;
                 o_far                   = 'x;
                 o_cache_tag             = 'x;
                 o_cache_inv_done        = 'x;
                 o_cache_clean_done      = 'x;
+                o_cache_range_done      = 'x;
                 o_cache_tag_dirty       = 'x;
                 o_cache_tag_wr_en       = 'x;
                 o_cache_line            = 'x;
@@ -826,18 +1080,18 @@ function automatic [CACHE_LINE-1:0] ben_comp (
 
 endfunction : ben_comp
 
-function automatic [31:0] clean_single_d (
+function automatic [WB_DATA_WIDTH-1:0] clean_single_d (
         input [CACHE_LINE*8-1:0]        cl,
-        input [$clog2(CACHE_LINE/4):0]  sh
+        input [$clog2(BEATS):0]         sh
 );
-        logic [$clog2(CACHE_LINE/4) + 5:0] shamt;
+        logic [$clog2(BEATS) + $clog2(WB_DATA_WIDTH):0] shamt;
 
         /* verilator lint_off UNUSEDSIGNAL */
-        logic [CACHE_LINE*8-32-1:0] dummy;
+        logic [CACHE_LINE*8-WB_DATA_WIDTH-1:0] dummy;
         /* verilator lint_on UNUSEDSIGNAL */
 
-        shamt                   = {sh, 5'd0};
-        {dummy, clean_single_d} = cl >> shamt; // Select specific 32-bit.
+        shamt                   = {sh, {$clog2(WB_DATA_WIDTH){1'd0}}};
+        {dummy, clean_single_d} = cl >> shamt; // Select specific beat.
 
 endfunction : clean_single_d
 
@@ -0,0 +1,259 @@
+//
+//  (C)2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+//
+//  Loop buffer. Sits in parallel with the I-cache and watches the stream
+//  of instructions accepted by the fetch stage. When the BTB predicts a
+//  short backward branch as taken, the next pass over the loop body is
+//  captured. If the same branch is again predicted taken to the same
+//  target at the end of that pass, the loop is locked in and the buffer
+//  replays it into the fetch stage. While locked, the PC generator is
+//  parked and issues no I-cache (and thus TLB) requests.
+//
+//  The loop is exited on any pipeline clear (mispredict, exception,
+//  interrupt), on I-cache/I-TLB invalidation (self modifying code) and
+//  on BTB clear. On a clear, the PC generator takes the new PC. On an
+//  invalidation, the PC generator resumes from o_pc_nxt which always
+//  points to the next instruction that would have been replayed.
+//
+//  Only 32-bit instructions are handled.
+//
+
+module zap_loop_buffer #(
+        // Number of instructions the buffer can hold. Must be >= 2.
+        parameter logic [31:0] DEPTH = 32'd8
+)
+(
+        // Clock and reset.
+        input logic             i_clk,
+        input logic             i_reset,
+
+        // Pipeline sync.
+        input logic             i_code_stall,
+        input logic             i_clear_from_writeback,
+        input logic             i_clear_from_alu,
+        input logic             i_clear_from_decode,
+
+        // Self modifying code/translation change.
+        input logic             i_icache_inv,
+        input logic             i_itlb_inv,
+        input logic             i_clear_btb,
+
+        // CPSR T bit.
+        input logic             i_cpsr_ff_t,
+
+        // Instruction stream from the I-cache, as seen by fetch.
+        input logic [31:0]      i_pc_ff,
+        input logic [31:0]      i_instruction,
+        input logic             i_valid,
+        input logic             i_instr_abort,
+        input logic [1:0]       i_taken,
+        input logic [32:0]      i_pred,
+
+        // Replay. Replaces the I-cache stream when o_lock = 1.
+        output logic            o_lock,
+        output logic [31:0]     o_pc_ff,
+        output logic [31:0]     o_pc_nxt,
+        output logic [31:0]     o_instruction,
+        output logic            o_valid,
+        output logic [1:0]      o_taken,
+        output logic [32:0]     o_pred
+);
+
+`include "zap_localparams.svh"
+
+localparam [31:0] PTR_WDT = $clog2(DEPTH);
+
+// State encoding.
+localparam [1:0] IDLE    = 2'd0;
+localparam [1:0] CAPTURE = 2'd1;
+localparam [1:0] REPLAY  = 2'd2;
+
+logic [1:0]         state_ff, state_nxt;
+logic [31:0]        start_ff, start_nxt; // Branch target (loop start).
+logic [31:0]        end_ff,   end_nxt;   // Branch address (loop end).
+logic [PTR_WDT-1:0] wptr_ff,  wptr_nxt;
+logic [PTR_WDT-1:0] rptr_ff,  rptr_nxt;
+logic [PTR_WDT-1:0] last_ff,  last_nxt;
+logic [31:0]        dist;
+logic               clear;
+logic               exit;
+logic               accept;
+logic               wr_en;
+
+// Loop body.
+logic [31:0]        instr_mem [DEPTH-1:0];
+logic [1:0]         taken_mem [DEPTH-1:0];
+
+logic unused;
+
+assign unused = |dist[1:0];
+
+// Distance from the branch back to its target.
+assign dist   = i_pc_ff - i_pred[31:0];
+
+assign clear  = i_clear_from_writeback | i_clear_from_alu | i_clear_from_decode;
+assign exit   = i_icache_inv | i_itlb_inv | i_clear_btb | i_cpsr_ff_t;
+assign accept = i_valid & ~i_code_stall & ~i_instr_abort;
+
+assign o_lock        = state_ff == REPLAY;
+assign o_valid       = state_ff == REPLAY;
+assign o_pc_ff       = start_ff + {{(30-PTR_WDT){1'd0}}, rptr_ff, 2'd0};
+assign o_pc_nxt      = start_ff + {{(30-PTR_WDT){1'd0}}, rptr_nxt, 2'd0};
+assign o_instruction = instr_mem[rptr_ff];
+
+//
+// The loop branch was predicted taken twice to lock in. Replay it as
+// strongly taken so that BTB updates are not made from the captured state.
+//
+assign o_taken       = rptr_ff == last_ff ? ST : taken_mem[rptr_ff];
+assign o_pred        = rptr_ff == last_ff ? {1'd1, start_ff} : 33'd0;
+
+always_comb
+begin
+        state_nxt = state_ff;
+        start_nxt = start_ff;
+        end_nxt   = end_ff;
+        wptr_nxt  = wptr_ff;
+        rptr_nxt  = rptr_ff;
+        last_nxt  = last_ff;
+        wr_en     = 1'd0;
+
+        if ( clear || exit )
+        begin
+                state_nxt = IDLE;
+        end
+        else
+        begin
+                case ( state_ff )
+
+                IDLE:
+                begin
+                        //
+                        // Predicted taken backward branch that fits in
+                        // the buffer. Capture the next pass.
+                        //
+                        if ( accept && i_pred[32] &&
+                             i_pred[31:0] <= i_pc_ff && {2'd0, dist[31:2]} < DEPTH )
+                        begin
+                                state_nxt = CAPTURE;
+                                start_nxt = i_pred[31:0];
+                                end_nxt   = i_pc_ff;
+                                wptr_nxt  = '0;
+                                last_nxt  = dist[PTR_WDT+1:2];
+                        end
+                end
+
+                CAPTURE:
+                begin
+                        if ( i_valid && !i_code_stall )
+                        begin
+                                wr_en    = 1'd1;
+                                wptr_nxt = wptr_ff + 'd1;
+
+                                // Instruction must be the next one in the body.
+                                if ( i_instr_abort ||
+                                     i_pc_ff != start_ff + {{(30-PTR_WDT){1'd0}}, wptr_ff, 2'd0} )
+                                begin
+                                        wr_en     = 1'd0;
+                                        state_nxt = IDLE;
+                                end
+                                else if ( wptr_ff == last_ff )
+                                begin
+                                        //
+                                        // Loop closed. The BTB will have
+                                        // steered the PC to start_ff.
+                                        //
+                                        if ( i_pc_ff == end_ff && i_pred == {1'd1, start_ff} )
+                                        begin
+                                                state_nxt = REPLAY;
+                                                rptr_nxt  = '0;
+                                        end
+                                        else
+                                        begin
+                                                state_nxt = IDLE;
+                                        end
+                                end
+                                else if ( i_pred[32] )
+                                begin
+                                        // Taken branch within the body.
+                                        wr_en     = 1'd0;
+                                        state_nxt = IDLE;
+                                end
+                        end
+                end
+
+                REPLAY:
+                begin
+                        // Pointer is advanced below.
+                end
+
+                default:
+                begin
+                        state_nxt = IDLE;
+                end
+
+                endcase
+        end
+
+        //
+        // Advance through the body. Done even on exit so that o_pc_nxt
+        // gives the PC generator the right address to resume from.
+        //
+        if ( state_ff == REPLAY && !clear && !i_code_stall )
+        begin
+                rptr_nxt = rptr_ff == last_ff ? '0 : rptr_ff + 'd1;
+        end
+end
+
+always_ff @ ( posedge i_clk )
+begin
+        if ( i_reset )
+        begin
+                state_ff <= IDLE;
+                start_ff <= 'x;
+                end_ff   <= 'x;
+                wptr_ff  <= 'x;
+                rptr_ff  <= 'x;
+                last_ff  <= 'x;
+        end
+        else
+        begin
+                state_ff <= state_nxt;
+                start_ff <= start_nxt;
+                end_ff   <= end_nxt;
+                wptr_ff  <= wptr_nxt;
+                rptr_ff  <= rptr_nxt;
+                last_ff  <= last_nxt;
+        end
+end
+
+// Loop body storage. No reset required.
+always_ff @ ( posedge i_clk )
+begin
+        if ( wr_en )
+        begin
+                instr_mem[wptr_ff] <= i_instruction;
+                taken_mem[wptr_ff] <= i_taken;
+        end
+end
+
+endmodule : zap_loop_buffer
+
+// ----------------------------------------------------------------------------
+// END OF FILE
+// ----------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+//
+// (C)2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//
+// Inter core mailbox. Wishbone slave. Each core has a mailbox made of two
+// registers. For core N:
+//
+// Offset 8N + 0 : DATA. A write stores the message and sets the bit of the
+//                 writing core in PEND of core N. A read returns the last
+//                 message.
+// Offset 8N + 4 : PEND. Bit M is set if core M has posted to this mailbox.
+//                 Write 1 to clear.
+//
+// The IRQ of core N is high while its PEND register is non zero. The writing
+// core is identified by i_src, which is the one-hot bus grant.
+//
+
+module zap_mailbox #(
+        // Number of cores. Must be < 32.
+        parameter logic [31:0] CORES = 32'd2
+)
+(
+
+// Clock and reset
+input logic                     i_clk,
+input logic                     i_reset,
+
+// Bus owner (one-hot).
+input logic [CORES-1:0]         i_src,
+
+// Wishbone slave. Address is the offset from the mailbox base.
+input logic                     i_wb_cyc,
+input logic                     i_wb_stb,
+input logic                     i_wb_wen,
+input logic [3:0]               i_wb_sel,
+input logic [31:0]              i_wb_dat,
+input logic [31:0]              i_wb_adr,
+output logic                    o_wb_ack,
+output logic [31:0]             o_wb_dat,
+
+// Interrupt to each core. Level.
+output logic [CORES-1:0]        o_irq
+
+);
+
+localparam [31:0] IDX_WDT = CORES > 1 ? $clog2(CORES) : 1;
+
+logic [CORES-1:0][31:0]         data_ff;
+logic [CORES-1:0][CORES-1:0]    pend_ff;
+logic [IDX_WDT-1:0]             idx;
+logic                           hit;
+logic [31:0]                    mask;
+logic                           unused;
+
+assign unused = |{i_wb_adr[31:IDX_WDT+3], i_wb_adr[1:0], i_wb_dat[31:CORES]};
+
+// Mailbox being accessed.
+assign idx    = i_wb_adr[IDX_WDT+2:3];
+assign hit    = {{(32-IDX_WDT){1'd0}}, idx} < CORES;
+
+// Byte select as a bit mask.
+assign mask   = {{8{i_wb_sel[3]}}, {8{i_wb_sel[2]}}, {8{i_wb_sel[1]}}, {8{i_wb_sel[0]}}};
+
+always_comb
+begin
+        for(int i=0;i<CORES;i++)
+        begin
+                o_irq[i] = |pend_ff[i];
+        end
+end
+
+always_ff @ ( posedge i_clk )
+begin
+        if ( i_reset )
+        begin
+                data_ff  <= '0;
+                pend_ff  <= '0;
+                o_wb_ack <= 1'd0;
+                o_wb_dat <= 32'd0;
+        end
+        else
+        begin
+                o_wb_ack <= 1'd0;
+
+                if ( i_wb_cyc && i_wb_stb && !o_wb_ack )
+                begin
+                        o_wb_ack <= 1'd1;
+
+                        if ( !hit )
+                        begin
+                                // No such mailbox. Writes are ignored.
+                                o_wb_dat <= 32'd0;
+                        end
+                        else if ( i_wb_wen )
+                        begin
+                                if ( !i_wb_adr[2] ) // DATA
+                                begin
+                                        data_ff[idx] <= (data_ff[idx] & ~mask) | (i_wb_dat & mask);
+                                        pend_ff[idx] <= pend_ff[idx] | i_src;
+                                end
+                                else // PEND
+                                begin
+                                        pend_ff[idx] <= pend_ff[idx] & ~(i_wb_dat[CORES-1:0] & mask[CORES-1:0]);
+                                end
+                        end
+                        else
+                        begin
+                                o_wb_dat <= i_wb_adr[2] ? {{(32-CORES){1'd0}}, pend_ff[idx]} : data_ff[idx];
+                        end
+                end
+        end
+end
+
+endmodule : zap_mailbox
+
+// ----------------------------------------------------------------------------
+// END OF FILE
+// ----------------------------------------------------------------------------
@@ -56,12 +56,27 @@ parameter logic [31:0]       CPSR_INIT          = {24'd0, 1'd1,1'd1,1'd0,5'b1001
 
 parameter logic  [0:0]       BE_32_ENABLE       = 1'd0,
 
+// -----------------------------------
+// Core ID. Read from CP15 (c0, op2 = 5)
+// -----------------------------------
+
+parameter logic  [7:0]       CORE_ID            = 8'd0,
+
+// -----------------------------------
+// Wishbone data bus width. 32 or 64.
+// A 64-bit bus halves the number of
+// beats in a cache line transfer.
+// -----------------------------------
+
+parameter logic  [31:0]      WB_DATA_WIDTH      = 32'd32,
+
 // -----------------------------------
 // BP entries, FIFO depths
 // -----------------------------------
 
 parameter logic  [31:0]       BP_ENTRIES         = 32'd512,  // Predictor depth.
 parameter logic  [31:0]       FIFO_DEPTH         = 32'd16,   // FIFO depth.
+parameter logic  [31:0]       LOOP_BUFFER_DEPTH  = 32'd0,    // Loop buffer depth.
 parameter logic  [31:0]       RAS_DEPTH          = 32'd4,    // Depth of RAS.
 
 // ----------------------------------
@@ -73,6 +88,7 @@ parameter logic [31:0] DATA_SPAGE_TLB_ENTRIES   =  32'd16,   // Small page TLB e
 parameter logic [31:0] DATA_FPAGE_TLB_ENTRIES   =  32'd32,   // Tiny page TLB entries.
 parameter logic [31:0] DATA_CACHE_SIZE          =  32'd8192, // Cache size in bytes.
 parameter logic [31:0] DATA_CACHE_LINE          =  32'd64,   // Cache line size in bytes.
+parameter logic [0:0]  DATA_CACHE_BG_WRITEBACK  =  1'd0,     // Write back dirty lines when idle.
 
 // ----------------------------------
 // Code MMU/Cache configuration.
@@ -117,17 +133,17 @@ parameter logic [31:0] CODE_CACHE_LINE          =  32'd64    // Ccahe line size
         // Wishbone interface.
         // ---------------------
 
-        output  logic            o_wb_cyc,
-        output  logic            o_wb_stb,
-        output  logic  [31:0]    o_wb_adr,
-        output  logic            o_wb_we,
-        output  logic  [31:0]    o_wb_dat,
-        output  logic  [3:0]     o_wb_sel,
-        output  logic  [2:0]     o_wb_cti,
-        output  logic  [1:0]     o_wb_bte,
-        input   logic            i_wb_ack,
-        input   logic  [31:0]    i_wb_dat,
-        input   logic            i_wb_err
+        output  logic                         o_wb_cyc,
+        output  logic                         o_wb_stb,
+        output  logic  [31:0]                 o_wb_adr,
+        output  logic                         o_wb_we,
+        output  logic  [WB_DATA_WIDTH-1:0]    o_wb_dat,
+        output  logic  [WB_DATA_WIDTH/8-1:0]  o_wb_sel,
+        output  logic  [2:0]                  o_wb_cti,
+        output  logic  [1:0]                  o_wb_bte,
+        input   logic                         i_wb_ack,
+        input   logic  [WB_DATA_WIDTH-1:0]    i_wb_dat,
+        input   logic                         i_wb_err
 );
 
 assign o_wb_bte = 2'b00; // Linear Burst.
@@ -136,8 +152,21 @@ assign o_wb_bte = 2'b00; // Linear Burst.
 `include "zap_localparams.svh"
 `include "zap_functions.svh"
 
+localparam [31:0] WB_BYTES = WB_DATA_WIDTH / 32'd8;
+localparam [31:0] WB_WORDS = WB_DATA_WIDTH / 32'd32;
+localparam [0:0]  WB_64    = WB_DATA_WIDTH == 32'd64;
+
 // Assertion.
 
+initial
+begin
+        assert ( WB_DATA_WIDTH == 32'd32 || WB_DATA_WIDTH == 32'd64 ) else
+        $fatal(2, "WB_DATA_WIDTH must be 32 or 64.");
+
+        assert ( WB_DATA_WIDTH == 32'd32 || (DATA_CACHE_LINE >= 32'd16 && CODE_CACHE_LINE >= 32'd16) ) else
+        $fatal(2, "Cache lines must be at least 16 bytes on a 64-bit bus.");
+end
+
 always@(posedge i_clk) // Assertion.
 begin
         if (!i_reset && o_wb_cyc)
@@ -147,8 +176,8 @@ begin
 end
 
 logic            wb_cyc, wb_stb, wb_we;
-logic [3:0]      wb_sel;
-logic [31:0]     wb_dat, wb_idat;
+logic [WB_BYTES-1:0]      wb_sel;
+logic [WB_DATA_WIDTH-1:0] wb_dat, wb_idat;
 logic [31:0]     wb_adr;
 logic [2:0]      wb_cti;
 logic            wb_ack;
@@ -161,11 +190,15 @@ logic [31:0]     cpu_iaddr, cpu_iaddr_nxt, cpu_iaddr_check;
 logic [7:0]      dc_fsr;
 logic [31:0]     dc_far;
 logic            cpu_dc_en, cpu_ic_en;
+logic            cpu_dc_stream;
 logic [1:0]      cpu_sr;
 logic [31:0]     cpu_baddr, cpu_dac_reg;
 logic            cpu_dc_inv, cpu_ic_inv;
 logic            cpu_dc_clean, cpu_ic_clean;
 logic            dc_inv_done, ic_inv_done, dc_clean_done, ic_clean_done;
+logic            cpu_dc_range, cpu_dc_range_clean, cpu_dc_range_inv;
+logic [31:0]     cpu_dc_range_start, cpu_dc_range_end;
+logic            dc_range_done;
 logic            cpu_dtlb_inv, cpu_itlb_inv;
 logic            data_ack, data_err, instr_ack, instr_err;
 logic [31:0]     ic_data, dc_data, cpu_dc_dat;
@@ -175,8 +208,8 @@ logic [3:0]      cpu_dc_sel;
 logic            c_wb_stb;
 logic            c_wb_cyc;
 logic            c_wb_wen;
-logic [3:0]      c_wb_sel;
-logic [31:0]     c_wb_dat;
+logic [WB_BYTES-1:0]      c_wb_sel;
+logic [WB_DATA_WIDTH-1:0] c_wb_dat;
 logic [31:0]     c_wb_adr;
 logic [2:0]      c_wb_cti;
 logic            c_wb_ack;
@@ -184,8 +217,8 @@ logic            c_wb_err;
 logic            d_wb_stb;
 logic            d_wb_cyc;
 logic            d_wb_wen;
-logic [3:0]      d_wb_sel;
-logic [31:0]     d_wb_dat;
+logic [WB_BYTES-1:0]      d_wb_sel;
+logic [WB_DATA_WIDTH-1:0] d_wb_dat;
 logic [31:0]     d_wb_adr;
 logic [2:0]      d_wb_cti;
 logic            d_wb_ack;
@@ -224,6 +257,8 @@ zap_core #(
         .CP15_L4_DEFAULT(CP15_L4_DEFAULT),
         .BP_ENTRIES(BP_ENTRIES),
         .FIFO_DEPTH(FIFO_DEPTH),
+        .LOOP_BUFFER_DEPTH(LOOP_BUFFER_DEPTH),
+        .CORE_ID(CORE_ID),
         .RAS_DEPTH(RAS_DEPTH),
         .BE_32_ENABLE(BE_32_ENABLE),
         .RESET_VECTOR(RESET_VECTOR),
@@ -254,7 +289,7 @@ zap_core #(
 /* verilator lint_on PINCONNECTEMPTY */
 .o_code_stall           (code_stall),
 
-.i_instr_wb_dat         (!ONLY_CORE ? ic_data   : i_wb_dat),
+.i_instr_wb_dat         (!ONLY_CORE ? ic_data   : wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr[2])),
 .i_instr_wb_ack         (instr_ack),
 .i_instr_wb_err         (instr_err),
 
@@ -269,8 +304,11 @@ zap_core #(
 /* verilator lint_on PINCONNECTEMPTY */
 .o_data_wb_stb          (cpu_dc_stb),
 .i_data_wb_dat          (!ONLY_CORE ? dc_data :
-                         BE_32_ENABLE ? be_32(i_wb_dat, o_wb_sel) : i_wb_dat),
+                         BE_32_ENABLE ? be_32(wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr[2]),
+                                              4'(o_wb_sel >> {WB_64 && o_wb_adr[2], 2'd0})) :
+                         wb_lane_dat(64'(i_wb_dat), WB_64 && o_wb_adr[2])),
                         // Swap data into CPU based on current o_wb_sel.
+                        // On a 64-bit bus, use the lane given by o_wb_adr.
 
 .i_data_wb_ack          (data_ack),
 .i_data_wb_err          (data_err),
@@ -292,10 +330,16 @@ zap_core #(
 .o_icache_inv           (cpu_ic_inv),
 .o_dcache_clean         (cpu_dc_clean),
 .o_icache_clean         (cpu_ic_clean),
+.o_dcache_range         (cpu_dc_range),
+.o_dcache_range_start   (cpu_dc_range_start),
+.o_dcache_range_end     (cpu_dc_range_end),
+.o_dcache_range_clean   (cpu_dc_range_clean),
+.o_dcache_range_inv     (cpu_dc_range_inv),
 .o_dtlb_inv             (cpu_dtlb_inv),
 .o_itlb_inv             (cpu_itlb_inv),
 .o_dcache_en            (cpu_dc_en),
 .o_icache_en            (cpu_ic_en),
+.o_dcache_stream        (cpu_dc_stream),
 .o_data_wb_adr_nxt      (cpu_daddr_nxt),
 // Data addr nxt. Used to drive address of data tag RAM.
 .o_data_wb_adr_check    (cpu_daddr_check),
@@ -315,6 +359,7 @@ zap_core #(
 .i_icache_inv_done      (!ONLY_CORE ? ic_inv_done : '0),
 .i_dcache_clean_done    (!ONLY_CORE ? dc_clean_done : '0),
 .i_icache_clean_done    (!ONLY_CORE ? ic_clean_done : '0),
+.i_dcache_range_done    (!ONLY_CORE ? dc_range_done : '0),
 .i_icache_err2          (!ONLY_CORE ? icache_err2 : '0),
 .i_dcache_err2          (!ONLY_CORE ? dcache_err2 : '0)
 );
@@ -332,6 +377,7 @@ begin : l_tieoffs_only_core
         assign ic_inv_done     = '0;
         assign dc_clean_done   = '0;
         assign ic_clean_done   = '0;
+        assign dc_range_done   = '0;
         assign icache_err2     = '0;
         assign dcache_err2     = '0;
         assign dc_fsr          = '0;
@@ -377,6 +423,7 @@ begin : l_tieoffs_only_core
          | (    |ic_inv_done       )
          | (    |dc_clean_done     )
          | (    |ic_clean_done     )
+         | (    |dc_range_done     )
          | (    |icache_err2       )
          | (    |dcache_err2       )
          | (    |dc_fsr            )
@@ -420,6 +467,7 @@ begin : l_tieoffs_only_core
          | (    |cpu_iaddr_check   )
          | (    |cpu_dc_en         )
          | (    |cpu_ic_en         )
+         | (    |cpu_dc_stream     )
          | (    |cpu_sr            )
          | (    |cpu_baddr         )
          | (    |cpu_dac_reg       )
@@ -427,6 +475,11 @@ begin : l_tieoffs_only_core
          | (    |cpu_ic_inv        )
          | (    |cpu_dc_clean      )
          | (    |cpu_ic_clean      )
+         | (    |cpu_dc_range      )
+         | (    |cpu_dc_range_start)
+         | (    |cpu_dc_range_end  )
+         | (    |cpu_dc_range_clean)
+         | (    |cpu_dc_range_inv  )
          | (    |cpu_dtlb_inv      )
          | (    |cpu_itlb_inv      )
          | (    |dc_rreg_idx       )
@@ -440,7 +493,7 @@ end : l_tieoffs_only_core
 if ( !ONLY_CORE )
 begin : l_merger_for_core_with_cache_mmu
 
-        zap_wb_merger #(.ONLY_CORE(1'd0)) u_zap_wb_merger (
+        zap_wb_merger #(.ONLY_CORE(1'd0), .WB_DATA_WIDTH(WB_DATA_WIDTH)) u_zap_wb_merger (
 
         .i_clk(i_clk),
         .i_reset(s_reset),
@@ -479,7 +532,7 @@ begin : l_merger_for_core_with_cache_mmu
 end : l_merger_for_core_with_cache_mmu
 else // if ( ONLY_CORE )
 begin : l_merger_for_core_without_cache_mmu
-        zap_wb_merger #(.ONLY_CORE(1'd1)) u_zap_wb_merger (
+        zap_wb_merger #(.ONLY_CORE(1'd1), .WB_DATA_WIDTH(WB_DATA_WIDTH)) u_zap_wb_merger (
 
         .i_clk(i_clk),
         .i_reset(s_reset),
@@ -487,8 +540,8 @@ begin : l_merger_for_core_without_cache_mmu
         .i_c_wb_stb(cpu_instr_stb),
         .i_c_wb_cyc(cpu_instr_stb),
         .i_c_wb_wen(1'h0),
-        .i_c_wb_sel(4'hF),
-        .i_c_wb_dat(32'd0),
+        .i_c_wb_sel(WB_BYTES'(wb_lane_sel(4'hF, WB_64 && cpu_iaddr[2]))),
+        .i_c_wb_dat('0),
         .i_c_wb_adr(cpu_iaddr),
         .i_c_wb_cti(3'b111),
         .o_c_wb_ack(instr_ack),
@@ -498,10 +551,12 @@ begin : l_merger_for_core_without_cache_mmu
         .i_d_wb_cyc(cpu_dc_stb),
         .i_d_wb_wen(cpu_dc_we),
 
-        // Swap sel from CPU if BE_32_ENABLE = 1.
-        .i_d_wb_sel(BE_32_ENABLE ? be_sel_32(cpu_dc_sel) : cpu_dc_sel),
+        // Swap sel from CPU if BE_32_ENABLE = 1. Then move it to the
+        // lane given by the address.
+        .i_d_wb_sel(WB_BYTES'(wb_lane_sel(BE_32_ENABLE ? be_sel_32(cpu_dc_sel) : cpu_dc_sel,
+                                          WB_64 && cpu_daddr[2]))),
 
-        .i_d_wb_dat(cpu_dc_dat),
+        .i_d_wb_dat({WB_WORDS{cpu_dc_dat}}),
         .i_d_wb_adr(cpu_daddr),
         .i_d_wb_cti(3'b111),
         .o_d_wb_ack(data_ack),
@@ -535,7 +590,9 @@ zap_dcache #(
         .SECTION_TLB_ENTRIES(DATA_SECTION_TLB_ENTRIES),
         .FPAGE_TLB_ENTRIES(DATA_FPAGE_TLB_ENTRIES),
         .CACHE_LINE(CODE_CACHE_LINE),
-        .BE_32_ENABLE(BE_32_ENABLE)
+        .BE_32_ENABLE(BE_32_ENABLE),
+        .BG_WRITEBACK(DATA_CACHE_BG_WRITEBACK),
+        .WB_DATA_WIDTH(WB_DATA_WIDTH)
 )
 u_data_cache (
 .i_clk                  (i_clk),
@@ -563,11 +620,18 @@ u_data_cache (
 .o_far                  (dc_far),
 .o_cache_inv_done       (dc_inv_done),
 .o_cache_clean_done     (dc_clean_done),
+.o_cache_range_done     (dc_range_done),
 
 .i_mmu_en               (cpu_mmu_en),
 .i_cache_en             (cpu_dc_en),
+.i_cache_stream         (cpu_dc_stream),
 .i_cache_inv_req        (cpu_dc_inv),
 .i_cache_clean_req      (cpu_dc_clean),
+.i_cache_range_req      (cpu_dc_range),
+.i_cache_range_start    (cpu_dc_range_start),
+.i_cache_range_end      (cpu_dc_range_end),
+.i_cache_range_clean    (cpu_dc_range_clean),
+.i_cache_range_inv      (cpu_dc_range_inv),
 .i_cpsr                 (cpu_mem_translate ? USR : cpu_cpsr[ZAP_CPSR_MODE:0]),
 .i_sr                   (cpu_sr),
 .i_baddr                (cpu_baddr),
@@ -605,7 +669,8 @@ zap_cache #(
 .LPAGE_TLB_ENTRIES(CODE_LPAGE_TLB_ENTRIES),
 .SECTION_TLB_ENTRIES(CODE_SECTION_TLB_ENTRIES),
 .FPAGE_TLB_ENTRIES(CODE_FPAGE_TLB_ENTRIES),
-.CACHE_LINE(DATA_CACHE_LINE)
+.CACHE_LINE(DATA_CACHE_LINE),
+.WB_DATA_WIDTH(WB_DATA_WIDTH)
 )
 u_code_cache (
 .i_clk              (i_clk),
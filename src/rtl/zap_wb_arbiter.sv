@@ -0,0 +1,175 @@
+//
+// (C)2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//
+// Arbitrates N Wishbone masters onto a single bus. Each master has a 2-bit
+// QoS level. Among the requesting masters, the one with the highest QoS level
+// is granted the bus. Ties are broken round robin, starting from the master
+// after the one that last owned the bus. With all QoS levels equal, this is
+// a plain round robin arbiter.
+//
+// Like zap_wb_merger, the bus is only given up when the owner drops STB or on
+// the last beat (CTI = EOB) of a transfer, so bursts are never broken up.
+// Masters must hold CYC/STB and the transfer attributes until ACK/ERR. Read
+// data from the bus is common to all masters and is not routed through here.
+//
+
+module zap_wb_arbiter #(
+        // Number of masters. Must be >= 1.
+        parameter logic [31:0] MASTERS       = 32'd2,
+
+        // Data bus width. 32 or 64.
+        parameter logic [31:0] WB_DATA_WIDTH = 32'd32
+)
+(
+
+// Clock and reset
+input logic                             i_clk,
+input logic                             i_reset,
+
+// QoS level of each master. Higher is more important.
+input logic [MASTERS-1:0][1:0]          i_qos,
+
+// Masters
+input logic [MASTERS-1:0]               i_wb_cyc,
+input logic [MASTERS-1:0]               i_wb_stb,
+input logic [MASTERS-1:0]               i_wb_wen,
+input logic [MASTERS-1:0][WB_DATA_WIDTH/8-1:0] i_wb_sel,
+input logic [MASTERS-1:0][WB_DATA_WIDTH-1:0]   i_wb_dat,
+input logic [MASTERS-1:0][31:0]         i_wb_adr,
+input logic [MASTERS-1:0][2:0]          i_wb_cti,
+input logic [MASTERS-1:0][1:0]          i_wb_bte,
+output logic [MASTERS-1:0]              o_wb_ack,
+output logic [MASTERS-1:0]              o_wb_err,
+
+// Common bus
+output logic                            o_wb_cyc,
+output logic                            o_wb_stb,
+output logic                            o_wb_wen,
+output logic [WB_DATA_WIDTH/8-1:0]      o_wb_sel,
+output logic [WB_DATA_WIDTH-1:0]        o_wb_dat,
+output logic [31:0]                     o_wb_adr,
+output logic [2:0]                      o_wb_cti,
+output logic [1:0]                      o_wb_bte,
+input logic                             i_wb_ack,
+input logic                             i_wb_err,
+
+// Bus status. Meant for performance monitoring. Leave open if unused.
+output logic [MASTERS-1:0]              o_req,
+output logic [MASTERS-1:0]              o_gnt
+
+);
+
+`include "zap_defines.svh"
+`include "zap_localparams.svh"
+
+localparam [31:0] IDX_WDT = MASTERS > 1 ? $clog2(MASTERS) : 1;
+
+logic [IDX_WDT-1:0] gnt_ff, gnt_nxt;
+logic               release_bus;
+
+////////////////////////////////////
+// Arbitration
+////////////////////////////////////
+
+assign o_req       = i_wb_cyc & i_wb_stb;
+
+// The owner is done with the bus.
+assign release_bus = !o_req[gnt_ff] ||
+                     ((i_wb_ack || i_wb_err) && (i_wb_cti[gnt_ff] == CTI_EOB));
+
+always_comb
+begin
+        logic [1:0]         best_qos;
+        logic               found;
+        logic [31:0]        idx;
+        logic [IDX_WDT-1:0] cand;
+
+        gnt_nxt  = gnt_ff;
+        best_qos = 2'd0;
+        found    = 1'd0;
+        idx      = 32'd0;
+        cand     = '0;
+
+        if ( release_bus )
+        begin
+                //
+                // Search starts after the current owner, which is
+                // looked at last.
+                //
+                for(int i=1;i<=MASTERS;i++)
+                begin
+                        idx = {{(32-IDX_WDT){1'd0}}, gnt_ff} + i;
+
+                        if ( idx >= MASTERS )
+                        begin
+                                idx = idx - MASTERS;
+                        end
+
+                        cand = idx[IDX_WDT-1:0];
+
+                        if ( o_req[cand] && (!found || i_qos[cand] > best_qos) )
+                        begin
+                                found    = 1'd1;
+                                best_qos = i_qos[cand];
+                                gnt_nxt  = cand;
+                        end
+                end
+        end
+end
+
+always_ff @ ( posedge i_clk )
+begin
+        if ( i_reset )
+        begin
+                gnt_ff <= '0;
+        end
+        else
+        begin
+                gnt_ff <= gnt_nxt;
+        end
+end
+
+////////////////////////////////////
+// Bus muxing
+////////////////////////////////////
+
+always_comb
+begin
+        o_gnt            = '0;
+        o_gnt[gnt_ff]    = o_req[gnt_ff];
+
+        o_wb_ack         = '0;
+        o_wb_err         = '0;
+        o_wb_ack[gnt_ff] = i_wb_ack;
+        o_wb_err[gnt_ff] = i_wb_err;
+end
+
+assign o_wb_cyc   = i_wb_cyc[gnt_ff];
+assign o_wb_stb   = i_wb_stb[gnt_ff];
+assign o_wb_wen   = i_wb_wen[gnt_ff];
+assign o_wb_sel   = i_wb_sel[gnt_ff];
+assign o_wb_dat   = i_wb_dat[gnt_ff];
+assign o_wb_adr   = i_wb_adr[gnt_ff];
+assign o_wb_cti   = i_wb_cti[gnt_ff];
+assign o_wb_bte   = i_wb_bte[gnt_ff];
+
+endmodule : zap_wb_arbiter
+
+// ----------------------------------------------------------------------------
+// END OF FILE
+// ----------------------------------------------------------------------------
@@ -28,46 +28,49 @@ module zap_wb_merger #(
         // If ONLY_CORE=0, use NXT ports from cache,
         // else use FF ports from CPU.
         //
-        parameter logic ONLY_CORE = 1'd0
+        parameter logic ONLY_CORE = 1'd0,
+
+        // Data bus width. 32 or 64.
+        parameter logic [31:0] WB_DATA_WIDTH = 32'd32
 )
 (
 
 // Clock and reset
-input logic             i_clk,
-input logic             i_reset,
+input logic                         i_clk,
+input logic                         i_reset,
 
 // Wishbone bus 1
-input logic             i_c_wb_stb,
-input logic             i_c_wb_cyc,
-input logic             i_c_wb_wen,
-input logic [3:0]       i_c_wb_sel,
-input logic [31:0]      i_c_wb_dat,
-input logic [31:0]      i_c_wb_adr,
-input logic [2:0]       i_c_wb_cti,
-output logic            o_c_wb_ack,
-output logic            o_c_wb_err,
+input logic                         i_c_wb_stb,
+input logic                         i_c_wb_cyc,
+input logic                         i_c_wb_wen,
+input logic  [WB_DATA_WIDTH/8-1:0]  i_c_wb_sel,
+input logic  [WB_DATA_WIDTH-1:0]    i_c_wb_dat,
+input logic  [31:0]                 i_c_wb_adr,
+input logic  [2:0]                  i_c_wb_cti,
+output logic                        o_c_wb_ack,
+output logic                        o_c_wb_err,
 
 // Wishbone bus 2
-input logic             i_d_wb_stb,
-input logic             i_d_wb_cyc,
-input logic             i_d_wb_wen,
-input logic [3:0]       i_d_wb_sel,
-input logic [31:0]      i_d_wb_dat,
-input logic [31:0]      i_d_wb_adr,
-input logic [2:0]       i_d_wb_cti,
-output logic            o_d_wb_ack,
-output logic            o_d_wb_err,
+input logic                         i_d_wb_stb,
+input logic                         i_d_wb_cyc,
+input logic                         i_d_wb_wen,
+input logic  [WB_DATA_WIDTH/8-1:0]  i_d_wb_sel,
+input logic  [WB_DATA_WIDTH-1:0]    i_d_wb_dat,
+input logic  [31:0]                 i_d_wb_adr,
+input logic  [2:0]                  i_d_wb_cti,
+output logic                        o_d_wb_ack,
+output logic                        o_d_wb_err,
 
 // Common bus
-output logic            o_wb_cyc,
-output logic            o_wb_stb,
-output logic            o_wb_wen,
-output logic [3:0]      o_wb_sel,
-output logic [31:0]     o_wb_dat,
-output logic [31:0]     o_wb_adr,
-output logic [2:0]      o_wb_cti,
-input logic             i_wb_ack,
-input logic             i_wb_err
+output logic                        o_wb_cyc,
+output logic                        o_wb_stb,
+output logic                        o_wb_wen,
+output logic [WB_DATA_WIDTH/8-1:0]  o_wb_sel,
+output logic [WB_DATA_WIDTH-1:0]    o_wb_dat,
+output logic [31:0]                 o_wb_adr,
+output logic [2:0]                  o_wb_cti,
+input logic                         i_wb_ack,
+input logic                         i_wb_err
 
 );
 
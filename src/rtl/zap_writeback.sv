@@ -60,6 +60,10 @@ module zap_writeback #(
         input logic                           i_clear_from_decode,
         input logic      [31:0]               i_pc_from_decode,
         input logic                           i_clear_from_icache,
+
+        // Loop buffer is supplying instructions. Track its PC.
+        input logic                           i_loop_lock,
+        input logic      [31:0]               i_pc_from_loop,
         input logic                           i_confirm_from_alu,
         input logic [31:0]                    i_alu_pc_ff,
         input logic [1:0]                     i_taken,
@@ -290,6 +294,18 @@ begin: pc_control_tree
                 pc_del2_nxt = pc_del2_ff;
                 pc_del3_nxt = pc_del3_ff;
         end
+        else if ( i_loop_lock )
+        begin
+                //
+                // Park the PC generator. No fetches are issued. Follow
+                // the loop buffer so that fetch resumes at the right
+                // place if it unlocks without a clear.
+                //
+                pc_nxt_tmp  = {1'd1, i_pc_from_loop};
+                pc_del_nxt  = 33'd0;
+                pc_del2_nxt = 33'd0;
+                pc_del3_nxt = 33'd0;
+        end
         else if ( shelve_ff )
         begin
                 pc_nxt_tmp  = {1'd1, pc_shelve_ff[31:0]};
@@ -25,6 +25,9 @@ add_files -scan_for_includes {
 ../../src/rtl/zap_ones_counter.sv \
 ../../src/rtl/zap_predecode_uop_sequencer.sv \
 ../../src/rtl/zap_wb_merger.sv \
+../../src/rtl/zap_wb_arbiter.sv \
+../../src/rtl/zap_mailbox.sv \
+../../src/rtl/zap_cluster.sv \
 ../../src/rtl/zap_shifter_shift.sv \
 ../../src/rtl/zap_cache_fsm.sv \
 ../../src/rtl/zap_alu_main.sv \
@@ -43,6 +46,7 @@ add_files -scan_for_includes {
 ../../src/rtl/zap_predecode_coproc.sv \
 ../../src/rtl/zap_writeback.sv \
 ../../src/rtl/zap_fetch_main.sv \
+../../src/rtl/zap_loop_buffer.sv \
 ../../src/rtl/zap_postalu_main.sv \
 ../../src/rtl/zap_decompile.sv \
 ../../src/rtl/zap_fifo.sv \
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <verilated.h>
+#include <verilated_vcd_c.h>
 #include "Vzap_test.h"
 #include <stdio.h>
 #include <string.h>
@@ -27,6 +28,15 @@
 #define KRED            "\x1B[31m"
 #define KGRN            "\x1B[32m"
 #define RESET_CYCLES    10
+#define CTI_BURST       2
+#define CTI_EOB         7
+#define WB_LOG          "zap_wb.log"
+#define WB_REPLAY_LOG   "zap_wb_replay.log"
+#define WB_LOG_MAGIC    "ZAPW"
+#define WB_LOG_VERSION  2
+#define WB_HDR_BYTES    16
+#define WB_REC_BYTES    24
+#define MAX_CPUS        32
 
 
 char mem [0x03FFFFFF]; // 64MB buffer.
@@ -47,20 +57,391 @@ int uart1_ctr = 0;
 unsigned int seed;
 int delay = -1;
 
-int main(int argc, char** argv, char** env) {
+// ----------------------------------------------------------------------------
+// Wishbone transaction log.
+//
+// Every acknowledged transfer is written to a binary log. The log can be
+// replayed to reproduce the bus timing of a run without the RNG, and the bus
+// protocol checks can be run offline over it. All fields are little endian.
+//
+// Header : "ZAPW", version (2), int_sel (2), seed (4), bus bytes (1),
+//          reserved (3).
+// Record : cycle (4), adr (4), dat (8), wait (2), idle (2), sel (1), cti (1),
+//          we (1), reserved (1).
+//
+// dat is the write data for writes and the read data for reads. Only the low
+// 4 bytes are used on a 32-bit bus. wait is the number of cycles CYC/STB were
+// held without ACK. idle is the number of cycles from the previous ACK to
+// CYC/STB going high.
+// ----------------------------------------------------------------------------
+
+struct wb_rec
+{
+    unsigned int   cycle;
+    unsigned int   adr;
+    unsigned long long dat;
+    unsigned short wait;
+    unsigned short idle;
+    unsigned char  sel;
+    unsigned char  cti;
+    unsigned char  we;
+};
+
+FILE          *wb_log;          // Log being written.
+FILE          *wb_replay;       // Log being replayed. NULL if not replaying.
+struct wb_rec  wb_exp;          // Next transfer expected from the replay log.
+int            wb_exp_valid;    // wb_exp holds a record.
+unsigned int   wb_idx;          // Transfer number.
+unsigned int   wb_wait;         // Wait states given to the current transfer.
+unsigned int   wb_idle;         // Cycles since the last ACK with CYC/STB low.
+unsigned int   wb_int_sel;      // Interrupt port select from the replay log.
+unsigned int   wb_replay_bytes; // Bus width in bytes from the replay log.
+int            wb_diverged;     // Replay no longer follows the log.
+long           wb_trace_from = -1; // Print transfers and dump waves from this cycle. -2 : From divergence.
+unsigned int   wb_bytes = 4;    // Bus width in bytes. 4 or 8.
+unsigned int   cycle;
+
+// ----------------------------------------------------------------------------
+// Burst statistics. A burst runs from the first CTI = BURST beat to the
+// CTI = EOB beat. Cycles are counted from the request of the first beat to the
+// ACK of the last, so this is the line fill/evict latency seen by the caches.
+// ----------------------------------------------------------------------------
+
+unsigned long  wb_bursts;               // Bursts completed.
+unsigned long  wb_burst_beats;          // Beats in completed bursts.
+unsigned long  wb_burst_cycles;         // Cycles spent in completed bursts.
+unsigned int   wb_burst_start;          // Start cycle of the current burst.
+unsigned int   wb_burst_len;            // Beats so far in the current burst.
+
+// ----------------------------------------------------------------------------
+// Per CPU statistics. Counted from reset release.
+// ----------------------------------------------------------------------------
+
+unsigned int   cpu_cnt;                 // Number of CPUs in the DUT.
+unsigned long  cpu_cycles;              // Cycles out of reset.
+unsigned long  cpu_retired [MAX_CPUS];  // Instructions retired.
+unsigned long  cpu_bus_req [MAX_CPUS];  // Cycles requesting the bus.
+unsigned long  cpu_bus_wait[MAX_CPUS];  // Cycles requesting the bus without owning it.
+
+// Called on every ACK. in_burst is set if an earlier beat was CTI = BURST.
+void wb_burst_sample ( unsigned int cti, int in_burst )
+{
+    if ( !in_burst )
+    {
+        if ( cti != CTI_BURST )
+        {
+            return;
+        }
+
+        wb_burst_start = cycle - wb_wait;
+        wb_burst_len   = 0;
+    }
+
+    wb_burst_len++;
+
+    if ( cti == CTI_EOB )
+    {
+        wb_bursts++;
+        wb_burst_beats  += wb_burst_len;
+        wb_burst_cycles += cycle - wb_burst_start + 1;
+    }
+}
+
+void wb_report ( void )
+{
+    printf("\nBus statistics (%u-bit bus):\n", wb_bytes * 8);
+    printf("Transfers %10u\n", wb_idx);
+    printf("Bursts    %10lu\n", wb_bursts);
+
+    if ( wb_bursts )
+    {
+        printf("Beats/burst  %7.2f\n", (double)wb_burst_beats  / wb_bursts);
+        printf("Cycles/burst %7.2f\n", (double)wb_burst_cycles / wb_bursts);
+        printf("Bytes/cycle  %7.2f\n", (double)wb_burst_beats * wb_bytes / wb_burst_cycles);
+    }
+}
+
+void cpu_sample ( unsigned int retire, unsigned int req, unsigned int gnt )
+{
+    cpu_cycles++;
+
+    for(unsigned int i=0;i<cpu_cnt && i<MAX_CPUS;i++)
+    {
+        cpu_retired [i] += (retire >> i) & 1;
+        cpu_bus_req [i] += (req >> i) & 1;
+        cpu_bus_wait[i] += ((req & ~gnt) >> i) & 1;
+    }
+}
+
+void cpu_report ( void )
+{
+    printf("\nCPU statistics over %lu cycles:\n", cpu_cycles);
+    printf("CPU Instructions      CPI Bus cycles  Bus waits Contention\n");
+
+    for(unsigned int i=0;i<cpu_cnt && i<MAX_CPUS;i++)
+    {
+        printf("%3u %12lu %8.3f %10lu %10lu %9.2f%%\n",
+                i,
+                cpu_retired[i],
+                cpu_retired[i] ? (double)cpu_cycles / cpu_retired[i] : 0.0,
+                cpu_bus_req[i],
+                cpu_bus_wait[i],
+                cpu_bus_req[i] ? 100.0 * cpu_bus_wait[i] / cpu_bus_req[i] : 0.0);
+    }
+
+    wb_report();
+}
+
+void wb_put ( unsigned char *buf, unsigned long long val, int bytes )
+{
+    for(int i=0;i<bytes;i++)
+    {
+        buf[i] = (val >> (8 * i)) & 0xFF;
+    }
+}
+
+unsigned long long wb_get ( const unsigned char *buf, int bytes )
+{
+    unsigned long long val = 0;
 
-    if ( argc == 4 )
+    for(int i=0;i<bytes;i++)
     {
-        seed = atoi(argv[3]);
+        val |= ((unsigned long long)buf[i]) << (8 * i);
+    }
+
+    return val;
+}
+
+void wb_write_hdr ( FILE *fp, unsigned int int_sel, unsigned int log_seed, unsigned int bytes )
+{
+    unsigned char buf[WB_HDR_BYTES];
+
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, WB_LOG_MAGIC, 4);
+    wb_put(buf + 4, WB_LOG_VERSION, 2);
+    wb_put(buf + 6, int_sel, 2);
+    wb_put(buf + 8, log_seed, 4);
+    wb_put(buf + 12, bytes, 1);
+    fwrite(buf, 1, sizeof(buf), fp);
+}
+
+// Returns 1 if the header is valid.
+int wb_read_hdr ( FILE *fp, unsigned int *int_sel, unsigned int *log_seed, unsigned int *bytes )
+{
+    unsigned char buf[WB_HDR_BYTES];
+
+    if ( fread(buf, 1, sizeof(buf), fp) != sizeof(buf) ||
+         memcmp(buf, WB_LOG_MAGIC, 4) != 0              ||
+         wb_get(buf + 4, 2) != WB_LOG_VERSION )
+    {
+        return 0;
+    }
+
+    *int_sel  = wb_get(buf + 6, 2);
+    *log_seed = wb_get(buf + 8, 4);
+    *bytes    = wb_get(buf + 12, 1);
+
+    return 1;
+}
+
+void wb_write_rec ( FILE *fp, const struct wb_rec *rec )
+{
+    unsigned char buf[WB_REC_BYTES];
+
+    memset(buf, 0, sizeof(buf));
+    wb_put(buf + 0,  rec->cycle, 4);
+    wb_put(buf + 4,  rec->adr,   4);
+    wb_put(buf + 8,  rec->dat,   8);
+    wb_put(buf + 16, rec->wait,  2);
+    wb_put(buf + 18, rec->idle,  2);
+    wb_put(buf + 20, rec->sel,   1);
+    wb_put(buf + 21, rec->cti,   1);
+    wb_put(buf + 22, rec->we,    1);
+    fwrite(buf, 1, sizeof(buf), fp);
+}
+
+// Returns 1 if a record was read.
+int wb_read_rec ( FILE *fp, struct wb_rec *rec )
+{
+    unsigned char buf[WB_REC_BYTES];
+
+    if ( fread(buf, 1, sizeof(buf), fp) != sizeof(buf) )
+    {
+        return 0;
+    }
+
+    rec->cycle = wb_get(buf + 0,  4);
+    rec->adr   = wb_get(buf + 4,  4);
+    rec->dat   = wb_get(buf + 8,  8);
+    rec->wait  = wb_get(buf + 16, 2);
+    rec->idle  = wb_get(buf + 18, 2);
+    rec->sel   = wb_get(buf + 20, 1);
+    rec->cti   = wb_get(buf + 21, 1);
+    rec->we    = wb_get(buf + 22, 1);
+
+    return 1;
+}
+
+void wb_print_rec ( const char *tag, unsigned int idx, const struct wb_rec *rec )
+{
+    printf("%s #%u cycle=%u %s adr=%08x dat=%0*llx sel=%x cti=%x wait=%u idle=%u\n",
+           tag, idx, rec->cycle, rec->we ? "W" : "R", rec->adr, wb_bytes * 2, rec->dat,
+           rec->sel, rec->cti, rec->wait, rec->idle);
+}
+
+int wb_same_rec ( const struct wb_rec *a, const struct wb_rec *b )
+{
+    return a->adr  == b->adr  && a->dat == b->dat && a->sel == b->sel &&
+           a->cti  == b->cti  && a->we  == b->we  && a->idle == b->idle &&
+           a->wait == b->wait;
+}
+
+//
+// Run the bus protocol checks over a log. These are the same checks that are
+// done during simulation. Returns 0 if the log is clean.
+//
+int wb_check ( const char *file )
+{
+    FILE          *fp = fopen(file, "rb");
+    struct wb_rec  prv, cur;
+    unsigned int   int_sel, log_seed, bytes;
+    unsigned int   n   = 0;
+    int            err = 0;
+
+    if ( fp == NULL )
+    {
+        printf("Failed to open bus log %s\n", file);
+        return 2;
+    }
+
+    if ( !wb_read_hdr(fp, &int_sel, &log_seed, &bytes) )
+    {
+        printf("Error: %s is not a bus log.\n", file);
+        fclose(fp);
+        return 2;
+    }
+
+    printf("Checking bus log %s (seed 'd%u, %u-bit bus)\n", file, log_seed, bytes * 8);
+
+    while ( wb_read_rec(fp, &cur) )
+    {
+        if ( n && prv.cti == CTI_BURST )
+        {
+            if ( cur.idle )
+            {
+                printf("Error: WB_CYC/STB going low in the middle of a burst. Cycle=%u\n", prv.cycle + 1);
+                err = err ? err : 3;
+            }
+
+            if ( cur.adr != prv.adr + bytes )
+            {
+                printf("Error: Burst addresses not sequential. Cycle=%u Rec=%x Exp=%x\n", cur.cycle, cur.adr, prv.adr + bytes);
+                err = err ? err : 4;
+            }
+
+            if ( cur.we != prv.we )
+            {
+                printf("Error: Burst does not hold sense constant. Cycle=%u Exp=%x Rec=%x\n", cur.cycle, prv.we, cur.we);
+                err = err ? err : 5;
+            }
+        }
+
+        prv = cur;
+        n++;
+    }
+
+    fclose(fp);
+
+    if ( err )
+    {
+        printf("%sError: Bus log check failed. %u transfers checked.\n%s", KRED, n, KNRM);
     }
     else
     {
-        seed = (unsigned int)time(0);
+        printf("%sOK : Bus log check passed. %u transfers checked.\n%s", KGRN, n, KNRM);
+    }
+
+    return err;
+}
+
+int main(int argc, char** argv, char** env) {
+
+    int          seed_given  = 0;
+    int          hdr_done    = 0;
+    const char  *replay_file = NULL;
+    const char  *check_file  = NULL;
+
+    //
+    // Optional arguments after the binary and the test name:
+    // <seed>, replay=<log>, from=<cycle>|div, check=<log>
+    //
+    for(int i=3;i<argc;i++)
+    {
+        if ( strncmp(argv[i], "replay=", 7) == 0 )
+        {
+            replay_file = argv[i] + 7;
+        }
+        else if ( strncmp(argv[i], "check=", 6) == 0 )
+        {
+            check_file = argv[i] + 6;
+        }
+        else if ( strncmp(argv[i], "from=", 5) == 0 )
+        {
+            wb_trace_from = strcmp(argv[i] + 5, "div") == 0 ? -2 : atol(argv[i] + 5);
+        }
+        else
+        {
+            seed       = atoi(argv[i]);
+            seed_given = 1;
+        }
+    }
+
+    // Offline check. No simulation is done.
+    if ( check_file )
+    {
+        return wb_check(check_file);
+    }
+
+    if ( replay_file )
+    {
+        wb_replay = fopen(replay_file, "rb");
+
+        if ( wb_replay == NULL || !wb_read_hdr(wb_replay, &wb_int_sel, &seed, &wb_replay_bytes) )
+        {
+            printf("Failed to open bus log %s", replay_file);
+            return 2;
+        }
+
+        wb_exp_valid = wb_read_rec(wb_replay, &wb_exp);
+        wb_log       = fopen(WB_REPLAY_LOG, "wb");
+
+        // Trace from the first divergent transfer unless told otherwise.
+        if ( wb_trace_from == -1 )
+        {
+            wb_trace_from = -2;
+        }
+
+        printf("\n############# Replaying bus log %s (seed 'd%d) ###############\n", replay_file, seed);
     }
+    else
+    {
+        if ( !seed_given )
+        {
+            seed = (unsigned int)time(0);
+        }
+
+        wb_log = fopen(WB_LOG, "wb");
 
-    printf("\n############# Simulator seed is 'd%d ###############\n", seed);
+        printf("\n############# Simulator seed is 'd%d ###############\n", seed);
 
-    srand(seed);
+        srand(seed);
+    }
+
+    if ( wb_log == NULL )
+    {
+        printf("Failed to create bus log.");
+        return 2;
+    }
 
     seq      = 0;
     end_nxt  = 0;
@@ -72,6 +453,10 @@ int main(int argc, char** argv, char** env) {
     contextp->traceEverOn(true);
 
     const std::unique_ptr<Vzap_test> zap_test{new Vzap_test{contextp.get(), "ZAP_TEST"}};
+    const std::unique_ptr<VerilatedVcdC> wave{new VerilatedVcdC};
+
+    // The wave file is opened only once tracing starts.
+    zap_test->trace(wave.get(), 99);
 
     if ( argc > 1 )
     {
@@ -93,8 +478,13 @@ int main(int argc, char** argv, char** env) {
 
     zap_test->i_reset  = 1;
     zap_test->i_clk    = 0;
-    zap_test->i_wb_dat = rand();
-    zap_test->i_wb_ack = rand() & 0x1;
+    zap_test->i_wb_dat = wb_replay ? 0 : rand();
+    zap_test->i_wb_ack = wb_replay ? 0 : rand() & 0x1;
+
+    if ( wb_trace_from == -1 )
+    {
+        wave->open("zap.vcd");
+    }
 
     while (!contextp->gotFinish())
     {
@@ -103,13 +493,18 @@ int main(int argc, char** argv, char** env) {
 
         zap_test->eval();
 
+        if ( wave->isOpen() )
+        {
+            wave->dump(contextp->time());
+        }
+
         if(!zap_test->i_clk)
         {
                 // End simulation on falling edge of clock.
 
                 if ( end_nxt )
                 {
-                        if ( argc == 4 )
+                        if ( seed_given || wb_replay )
                         {
                                 printf("%s\nError: Ending simulation due to error. Waves are here : obj/ts/%s/zap.vcd\n%s", KRED, argv[2], KNRM);
                         }
@@ -118,6 +513,12 @@ int main(int argc, char** argv, char** env) {
                                 printf("%s\nError: Ending simulation due to error. Pass seed=%d manually to get waves.\n%s", KRED, seed, KNRM);
                         }
 
+                        printf("Bus log is here : obj/ts/%s/%s\n", argv[2], wb_replay ? WB_REPLAY_LOG : WB_LOG);
+
+                        cpu_report();
+
+                        fclose(wb_log);
+                        wave->close();
                         zap_test->final();
                         return end_nxt;
                 }
@@ -126,14 +527,40 @@ int main(int argc, char** argv, char** env) {
         {
             // Operate everything on rising edge of clock.
 
+            cycle++;
+
             if ( contextp->time() < RESET_CYCLES )
             {
                 zap_test->i_reset = 1;
-                zap_test->i_int_sel = (rand() & 0x1); // Select IRQ or FIQ port.
+                zap_test->i_int_sel = wb_replay ? wb_int_sel : (rand() & 0x1); // Select IRQ or FIQ port.
             }
             else
             {
                 zap_test->i_reset = 0;
+
+                // Interrupt port select is final once out of reset.
+                if ( !hdr_done )
+                {
+                        hdr_done = 1;
+                        cpu_cnt  = zap_test->o_cpu_cnt;
+                        wb_bytes = zap_test->o_wb_bytes;
+
+                        wb_write_hdr(wb_log, zap_test->i_int_sel, seed, wb_bytes);
+
+                        if ( wb_replay && wb_replay_bytes != wb_bytes )
+                        {
+                                printf("Error: Bus log is for a %u-bit bus. DUT bus is %u-bit.\n", wb_replay_bytes * 8, wb_bytes * 8);
+                                end_nxt = 10;
+                        }
+                }
+
+                cpu_sample(zap_test->o_cpu_retire, zap_test->o_bus_req, zap_test->o_bus_gnt);
+            }
+
+            if ( wb_trace_from >= 0 && cycle == (unsigned long)wb_trace_from )
+            {
+                printf("Tracing bus transfers and dumping waves from cycle %u.\n", cycle);
+                wave->open("zap.vcd");
             }
 
             if ( seq && (!zap_test->o_wb_cyc || !zap_test->o_wb_stb) )
@@ -145,11 +572,25 @@ int main(int argc, char** argv, char** env) {
             // Simulate a Wishbone RAM.
             if ( zap_test->o_wb_cyc && zap_test->o_wb_stb && !zap_test -> i_reset )
             {
+                    int respond = 0;
+
                     // Randomly give delay between 0 and 50 cycles per
                     // transfer, when seed is even. When seed is odd,
-                    // give response immediately.
+                    // give response immediately. When replaying, give
+                    // the same delay as in the log. Once the replay has
+                    // diverged, give response immediately.
+
+                    if ( wb_replay )
+                    {
+                        respond = wb_diverged || !wb_exp_valid || wb_wait >= wb_exp.wait;
 
-                    if ( (seed % 2 == 0) && delay == -1 && (rand() % 2) )
+                        if ( !respond )
+                        {
+                                zap_test->i_wb_ack = 0;
+                                zap_test->i_wb_dat = 0;
+                        }
+                    }
+                    else if ( (seed % 2 == 0) && delay == -1 && (rand() % 2) )
                     {
                         delay = (rand() % 50) + 1;
                         zap_test->i_wb_ack = 0;
@@ -164,35 +605,54 @@ int main(int argc, char** argv, char** env) {
                     }
                     else if (delay <= 0)
                     {
+                        respond = 1;
+                    }
+
+                    if ( !respond )
+                    {
+                            wb_wait++;
+                    }
+                    else
+                    {
+                            struct wb_rec rec;
+
                             delay = -1;
 
-                            // Give bus response.
+                            // Give bus response. The RAM is as wide as the
+                            // bus. Byte N of the bus word is at base + N.
+                            unsigned int base = (zap_test->o_wb_adr / wb_bytes) * wb_bytes;
+
                             if( !zap_test->o_wb_we )
                             {
-                                    zap_test->i_wb_ack = 1;
-                                    zap_test->i_wb_dat = 0;
+                                    unsigned long long dat = 0;
+
+                                    for(unsigned int j=0;j<wb_bytes;j++)
+                                    {
+                                        dat |= ((unsigned long long)(mem[(base + j) & 0x3FFFFFF] & 0xFF)) << (8 * j);
+                                    }
 
-                                    zap_test->i_wb_dat |= ((mem[((zap_test->o_wb_adr >> 2)*4 + 0) & 0x3FFFFFF]) & 0xFF) << (8 * 0);
-                                    zap_test->i_wb_dat |= ((mem[((zap_test->o_wb_adr >> 2)*4 + 1) & 0x3FFFFFF]) & 0xFF) << (8 * 1);
-                                    zap_test->i_wb_dat |= ((mem[((zap_test->o_wb_adr >> 2)*4 + 2) & 0x3FFFFFF]) & 0xFF) << (8 * 2);
-                                    zap_test->i_wb_dat |= ((mem[((zap_test->o_wb_adr >> 2)*4 + 3) & 0x3FFFFFF]) & 0xFF) << (8 * 3);
+                                    zap_test->i_wb_ack = 1;
+                                    zap_test->i_wb_dat = dat;
                             }
                             else
                             {
                                     zap_test->i_wb_ack   = 1;
-                                    zap_test->i_wb_dat   = rand();
-
-                                    if ( zap_test->o_wb_sel & 1 ) mem [ ((zap_test->o_wb_adr >> 2)*4 + 0) & 0x3FFFFFF ] = (zap_test->o_wb_dat >> (8 * 0)) & 0xFF;
-                                    if ( zap_test->o_wb_sel & 2 ) mem [ ((zap_test->o_wb_adr >> 2)*4 + 1) & 0x3FFFFFF ] = (zap_test->o_wb_dat >> (8 * 1)) & 0xFF;
-                                    if ( zap_test->o_wb_sel & 4 ) mem [ ((zap_test->o_wb_adr >> 2)*4 + 2) & 0x3FFFFFF ] = (zap_test->o_wb_dat >> (8 * 2)) & 0xFF;
-                                    if ( zap_test->o_wb_sel & 8 ) mem [ ((zap_test->o_wb_adr >> 2)*4 + 3) & 0x3FFFFFF ] = (zap_test->o_wb_dat >> (8 * 3)) & 0xFF;
+                                    zap_test->i_wb_dat   = wb_replay ? 0 : rand();
+
+                                    for(unsigned int j=0;j<wb_bytes;j++)
+                                    {
+                                        if ( (zap_test->o_wb_sel >> j) & 1 )
+                                        {
+                                            mem [ (base + j) & 0x3FFFFFF ] = (zap_test->o_wb_dat >> (8 * j)) & 0xFF;
+                                        }
+                                    }
                             }
 
                             if ( seq && zap_test->i_wb_ack )
                             {
-                                if ( zap_test->o_wb_adr != saved_adr + 4 )
+                                if ( zap_test->o_wb_adr != saved_adr + wb_bytes )
                                 {
-                                        printf("Error: Burst addresses not sequential. Rec=%x Exp=%x\n", zap_test->o_wb_adr, saved_adr + 4);
+                                        printf("Error: Burst addresses not sequential. Rec=%x Exp=%x\n", zap_test->o_wb_adr, saved_adr + wb_bytes);
                                         end_nxt = 4;
                                 }
 
@@ -202,9 +662,61 @@ int main(int argc, char** argv, char** env) {
                                         end_nxt = 5;
                                 }
                             }
+
+                            // Log the transfer.
+                            rec.cycle = cycle;
+                            rec.adr   = zap_test->o_wb_adr;
+                            rec.dat   = zap_test->o_wb_we ? zap_test->o_wb_dat : zap_test->i_wb_dat;
+                            rec.wait  = wb_wait > 0xFFFF ? 0xFFFF : wb_wait;
+                            rec.idle  = wb_idle > 0xFFFF ? 0xFFFF : wb_idle;
+                            rec.sel   = zap_test->o_wb_sel;
+                            rec.cti   = zap_test->o_wb_cti;
+                            rec.we    = zap_test->o_wb_we;
+
+                            wb_write_rec(wb_log, &rec);
+                            wb_burst_sample(rec.cti, seq);
+
+                            // Compare with the replay log.
+                            if ( wb_replay && !wb_diverged )
+                            {
+                                if ( !wb_exp_valid || !wb_same_rec(&rec, &wb_exp) )
+                                {
+                                        printf("Error: Bus transfer diverged from the log.\n");
+
+                                        if ( wb_exp_valid )
+                                        {
+                                                wb_print_rec("Exp", wb_idx, &wb_exp);
+                                        }
+                                        else
+                                        {
+                                                printf("Exp #%u : End of log.\n", wb_idx);
+                                        }
+
+                                        wb_print_rec("Rec", wb_idx, &rec);
+
+                                        wb_diverged = 1;
+
+                                        if ( wb_trace_from == -2 )
+                                        {
+                                                wb_trace_from = cycle;
+                                                wave->open("zap.vcd");
+                                        }
+                                }
+
+                                wb_exp_valid = wb_read_rec(wb_replay, &wb_exp);
+                            }
+
+                            if ( wb_trace_from >= 0 && cycle >= (unsigned long)wb_trace_from )
+                            {
+                                wb_print_rec("WB", wb_idx, &rec);
+                            }
+
+                            wb_idx++;
+                            wb_wait = 0;
+                            wb_idle = 0;
                     }
 
-                    if ( zap_test->o_wb_cti == 2 && zap_test->i_wb_ack )
+                    if ( zap_test->o_wb_cti == CTI_BURST && zap_test->i_wb_ack )
                     {
                         seq       = 1;
                         saved_adr = zap_test->o_wb_adr;
@@ -218,7 +730,12 @@ int main(int argc, char** argv, char** env) {
             else
             {
                     zap_test->i_wb_ack = 0;
-                    zap_test->i_wb_dat = rand();
+                    zap_test->i_wb_dat = wb_replay ? 0 : rand();
+
+                    if ( !zap_test->i_reset )
+                    {
+                        wb_idle++;
+                    }
             }
 
             // Print UART output on line 0 and line 1.
@@ -261,11 +778,19 @@ int main(int argc, char** argv, char** env) {
                     printf("Error : Register/memory mismatch.\n");
                     end_nxt = 6;
             }
+            else if ( zap_test->o_sim_ok && !zap_test->i_reset && wb_diverged )
+            {
+                        printf("Error : Simulation passed but the bus diverged from the replay log.\n");
+                        end_nxt = 10;
+            }
             else if ( zap_test->o_sim_ok && !zap_test->i_reset )
             {
                         if ( strcmp(argv[2], "uart") != 0 )
                         {
+                                cpu_report();
                                 printf("%sOK : Simulation passed!\n%s", KGRN, KNRM);
+                                fclose(wb_log);
+                                wave->close();
                                 zap_test->final();
                                 return 0;
                         }
@@ -273,7 +798,10 @@ int main(int argc, char** argv, char** env) {
                         {
                                 if ( uart0_ctr == strlen(word0) && uart1_ctr == strlen(word1))
                                 {
+                                        cpu_report();
                                         printf("%sOK : Simulation passed!\n%s", KGRN, KNRM);
+                                        fclose(wb_log);
+                                        wave->close();
                                         zap_test->final();
                                         return 0;
                                 }
@@ -287,7 +815,10 @@ int main(int argc, char** argv, char** env) {
         } // rising edge of clock
     } // while
 
+    fclose(wb_log);
+    wave->close();
     zap_test->final();
+    cpu_report();
     printf("%sError: Simulation failed!\n%s", KRED, KNRM);
     return 7;
 }
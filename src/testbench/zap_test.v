@@ -23,6 +23,7 @@
 // VIC0   address space FFFFFFA0 to FFFFFFBF
 // UART1  address space FFFFFF80 to FFFFFF9F
 // Timer1 address space FFFFFF60 to FFFFFF7F
+// MBOX   address space FFFFFF40 to FFFFFF5F (Only when CORES > 1)
 //
 
 module zap_test (
@@ -36,41 +37,47 @@ module zap_test (
         output reg             o_wb_stb,
         output reg             o_wb_cyc,
         output reg     [31:0]  o_wb_adr,
-        output reg     [3:0]   o_wb_sel,
+        output reg     [7:0]   o_wb_sel,   // Upper 4 bits zero on a 32-bit bus.
         output reg             o_wb_we,
-        output reg     [31:0]  o_wb_dat,
+        output reg     [63:0]  o_wb_dat,   // Upper 32 bits zero on a 32-bit bus.
         output reg      [2:0]  o_wb_cti,
         input  wire            i_wb_ack,
-        input  wire    [31:0]  i_wb_dat,
+        input  wire    [63:0]  i_wb_dat,
+        output wire    [7:0]   o_wb_bytes, // Bus width in bytes. 4 or 8.
 
         input  wire    [7:0]   i_mem [65536-1:0],
 
+        // Per CPU status. Bit N is for CPU N.
+        output wire    [7:0]   o_cpu_cnt,
+        output wire    [31:0]  o_cpu_retire,
+        output wire    [31:0]  o_bus_req,
+        output wire    [31:0]  o_bus_gnt,
+
         output wire            UART_SR_DAV_0,
         output wire            UART_SR_DAV_1,
         output wire    [7:0]   UART_SR_0,
         output wire    [7:0]   UART_SR_1
 );
 
-initial
-begin
-        $dumpfile("zap.vcd");
-        $dumpvars;
-end
-
 parameter DATA_SECTION_TLB_ENTRIES      = 4;
 parameter DATA_LPAGE_TLB_ENTRIES        = 8;
 parameter DATA_SPAGE_TLB_ENTRIES        = 16;
 parameter DATA_FPAGE_TLB_ENTRIES        = 32;
 parameter DATA_CACHE_SIZE               = 1024;
+parameter DATA_CACHE_BG_WRITEBACK       = 0;
 parameter CODE_SECTION_TLB_ENTRIES      = 4;
 parameter CODE_LPAGE_TLB_ENTRIES        = 8;
 parameter CODE_SPAGE_TLB_ENTRIES        = 16;
 parameter CODE_FPAGE_TLB_ENTRIES        = 32;
 parameter CODE_CACHE_SIZE               = 1024;
 parameter FIFO_DEPTH                    = 4;
+parameter LOOP_BUFFER_DEPTH             = 0;
 parameter BP_ENTRIES                    = 1024;
 parameter ONLY_CORE                     = 0;
 parameter BE_32_ENABLE                  = 0;
+parameter CORES                         = 1;
+parameter CORE_QOS                      = 0;
+parameter WB_DATA_WIDTH                 = 32;
 
 
 localparam STRING_LENGTH                = 12;
@@ -152,22 +159,30 @@ uart_tx_dumper u_uart_tx_dumper_dev1 (  .i_clk(i_clk), .i_line(o_uart[1]),
 // DUT
 chip_top #(
         .FIFO_DEPTH(FIFO_DEPTH),
+        .LOOP_BUFFER_DEPTH(LOOP_BUFFER_DEPTH),
         .BP_ENTRIES(BP_ENTRIES),
         .DATA_SECTION_TLB_ENTRIES(DATA_SECTION_TLB_ENTRIES),
         .DATA_LPAGE_TLB_ENTRIES(DATA_LPAGE_TLB_ENTRIES),
         .DATA_SPAGE_TLB_ENTRIES(DATA_SPAGE_TLB_ENTRIES),
         .DATA_FPAGE_TLB_ENTRIES(DATA_FPAGE_TLB_ENTRIES),
         .DATA_CACHE_SIZE(DATA_CACHE_SIZE),
+        .DATA_CACHE_BG_WRITEBACK(DATA_CACHE_BG_WRITEBACK),
         .CODE_SECTION_TLB_ENTRIES(CODE_SECTION_TLB_ENTRIES),
         .CODE_LPAGE_TLB_ENTRIES(CODE_LPAGE_TLB_ENTRIES),
         .CODE_SPAGE_TLB_ENTRIES(CODE_SPAGE_TLB_ENTRIES),
         .CODE_FPAGE_TLB_ENTRIES(CODE_FPAGE_TLB_ENTRIES),
         .CODE_CACHE_SIZE(CODE_CACHE_SIZE),
         .BE_32_ENABLE(BE_32_ENABLE),
-        .ONLY_CORE(ONLY_CORE)
+        .ONLY_CORE(ONLY_CORE),
+        .CORES(CORES),
+        .CORE_QOS(CORE_QOS),
+        .WB_DATA_WIDTH(WB_DATA_WIDTH)
 ) u_chip_top (
         .SYS_CLK  (i_clk),
         .SYS_RST  (i_reset),
+        .O_CPU_RETIRE(o_cpu_retire),
+        .O_BUS_REQ(o_bus_req),
+        .O_BUS_GNT(o_bus_gnt),
         .UART0_RXD(i_uart[0]),
         .UART0_TXD(o_uart[0]),
         .UART1_RXD(i_uart[1]),
@@ -186,6 +201,9 @@ chip_top #(
         .O_WB_CTI(o_wb_cti)
 );
 
+assign o_cpu_cnt  = CORES;
+assign o_wb_bytes = WB_DATA_WIDTH / 8;
+
 integer sim_ctr = 0;
 
 always @ ( posedge i_clk )
@@ -200,6 +218,62 @@ begin
         end
 end
 
+// Loop buffer activity on processor 0. Examine these through REG_CHECK.
+reg lb_replay   = 1'd0; // A loop was replayed.
+reg lb_inv_exit = 1'd0; // A replay was ended by an I-cache invalidate.
+
+if ( LOOP_BUFFER_DEPTH != 0 )
+begin : l_loop_buffer_monitor
+        always @ ( posedge i_clk )
+        begin
+                if ( `CPU_HIER.u_zap_core.l_loop_buffer.u_zap_loop_buffer.o_lock )
+                begin
+                        lb_replay <= 1'd1;
+
+                        if ( `CPU_HIER.u_zap_core.l_loop_buffer.u_zap_loop_buffer.i_icache_inv )
+                                lb_inv_exit <= 1'd1;
+                end
+        end
+end : l_loop_buffer_monitor
+
+// Background write back activity on processor 0. Examine through REG_CHECK.
+reg dc_bg_wb = 1'd0; // D-cache wrote back a line in the background.
+
+if ( DATA_CACHE_BG_WRITEBACK != 0 && ONLY_CORE == 0 )
+begin : l_bg_writeback_monitor
+        always @ ( posedge i_clk )
+        begin
+                if ( `CPU_HIER.l_generate_with_cache_mmu.u_data_cache.u_zap_cache_tag_ram.o_bg_busy )
+                        dc_bg_wb <= 1'd1;
+        end
+end : l_bg_writeback_monitor
+
+// Bus arbitration in a cluster. Examine these through REG_CHECK.
+reg bus_contend = 1'd0; // Processors requested the bus together.
+reg bus_qos_err = 1'd0; // Bus went to a processor with a lower QoS level than a requester.
+
+`define ARB_HIER u_chip_top.l_cluster.u_zap_cluster.u_zap_wb_arbiter
+
+if ( CORES > 1 )
+begin : l_bus_monitor
+        always @ ( posedge i_clk )
+        begin
+                if ( `ARB_HIER.release_bus )
+                begin
+                        if ( $countones(`ARB_HIER.o_req) > 1 )
+                                bus_contend <= 1'd1;
+
+                        for(int i=0;i<CORES;i++)
+                        begin
+                                if ( `ARB_HIER.o_req[i] && `ARB_HIER.i_qos[i] > `ARB_HIER.i_qos[`ARB_HIER.gnt_nxt] )
+                                        bus_qos_err <= 1'd1;
+                        end
+                end
+        end
+end : l_bus_monitor
+
+`undef ARB_HIER
+
 // Expose the CPU registers.
 wire [31:0] r0   =  `REG_HIER.mem[0];
 wire [31:0] r1   =  `REG_HIER.mem[1];
@@ -252,21 +326,36 @@ parameter DATA_LPAGE_TLB_ENTRIES        = 8,
 parameter DATA_SPAGE_TLB_ENTRIES        = 16,
 parameter DATA_FPAGE_TLB_ENTRIES        = 32,
 parameter DATA_CACHE_SIZE               = 1024,
+parameter DATA_CACHE_BG_WRITEBACK       = 0,
 parameter CODE_SECTION_TLB_ENTRIES      = 4,
 parameter CODE_LPAGE_TLB_ENTRIES        = 8,
 parameter CODE_SPAGE_TLB_ENTRIES        = 16,
 parameter CODE_FPAGE_TLB_ENTRIES        = 32,
 parameter CODE_CACHE_SIZE               = 1024,
 parameter FIFO_DEPTH                    = 4,
+parameter LOOP_BUFFER_DEPTH             = 0,
 parameter BP_ENTRIES                    = 1024,
 parameter BE_32_ENABLE                  = 0,
-parameter ONLY_CORE                     = 0
+parameter ONLY_CORE                     = 0,
+
+// Cluster config. CORES must be 1 to 4. CORE_QOS has 2 bits per CPU.
+parameter CORES                         = 1,
+parameter CORE_QOS                      = 0,
+
+// External bus width. 32 or 64. Peripherals are 32-bit and use the lane
+// selected by address bit 2.
+parameter WB_DATA_WIDTH                 = 32
 
 )(
         // Clk and rst
         input wire          SYS_CLK,
         input wire          SYS_RST,
 
+        // Per CPU status. Bit N is for CPU N.
+        output wire [31:0]  O_CPU_RETIRE,   // Instruction retired.
+        output wire [31:0]  O_BUS_REQ,      // Requesting the bus.
+        output wire [31:0]  O_BUS_GNT,      // Owns the bus.
+
         // UART 0
         input  wire         UART0_RXD,
         output wire         UART0_TXD,
@@ -287,13 +376,13 @@ parameter ONLY_CORE                     = 0
         // External Wishbone Connection (for RAMs etc).
         output reg          O_WB_STB,
         output reg          O_WB_CYC,
-        output wire [31:0]  O_WB_DAT,
-        output wire [31:0]  O_WB_ADR,
-        output wire [3:0]   O_WB_SEL,
-        output wire         O_WB_WE,
-        output wire [2:0]   O_WB_CTI,
-        input  wire         I_WB_ACK,
-        input  wire [31:0]  I_WB_DAT
+        output wire [WB_DATA_WIDTH-1:0]   O_WB_DAT,
+        output wire [31:0]                O_WB_ADR,
+        output wire [WB_DATA_WIDTH/8-1:0] O_WB_SEL,
+        output wire                       O_WB_WE,
+        output wire [2:0]                 O_WB_CTI,
+        input  wire                       I_WB_ACK,
+        input  wire [WB_DATA_WIDTH-1:0]   I_WB_DAT
 );
 
 // Peripheral addresses.
@@ -307,6 +396,7 @@ localparam UART1_LO                     = 32'hFFFFFF80;
 localparam UART1_HI                     = 32'hFFFFFF9F;
 localparam TIMER1_LO                    = 32'hFFFFFF60;
 localparam TIMER1_HI                    = 32'hFFFFFF7F;
+localparam MBOX_LO                      = 32'hFFFFFF40; // Inside the cluster.
 
 // Internal signals.
 wire            i_clk    = SYS_CLK;
@@ -320,15 +410,17 @@ assign          uart_in = {UART1_RXD, UART0_RXD};
 
 wire            data_wb_cyc;
 wire            data_wb_stb;
-reg [31:0]      data_wb_din;
+reg [WB_DATA_WIDTH-1:0] data_wb_din;
 reg             data_wb_ack;
 reg             data_wb_cyc_uart [1:0], data_wb_cyc_timer [1:0], data_wb_cyc_vic;
 reg             data_wb_stb_uart [1:0], data_wb_stb_timer [1:0], data_wb_stb_vic;
 wire [31:0]     data_wb_din_uart [1:0], data_wb_din_timer [1:0], data_wb_din_vic;
 wire            data_wb_ack_uart [1:0], data_wb_ack_timer [1:0], data_wb_ack_vic;
-wire [3:0]      data_wb_sel;
+wire [WB_DATA_WIDTH/8-1:0] data_wb_sel;
 wire            data_wb_we;
-wire [31:0]     data_wb_dout;
+wire [WB_DATA_WIDTH-1:0]   data_wb_dout;
+wire [3:0]      periph_wb_sel;  // 32-bit lane for peripherals.
+wire [31:0]     periph_wb_dout;
 wire [31:0]     data_wb_adr;
 wire [2:0]      data_wb_cti; // Cycle Type Indicator.
 wire            global_irq;
@@ -342,6 +434,10 @@ assign        O_WB_DAT        = data_wb_dout;
 assign        O_WB_SEL        = data_wb_sel;
 assign        O_WB_CTI        = data_wb_cti;
 
+// Peripherals are 32-bit. Pick the lane on a 64-bit bus.
+assign        periph_wb_sel   = (WB_DATA_WIDTH == 64 && data_wb_adr[2]) ? data_wb_sel[WB_DATA_WIDTH/8-1 -: 4]  : data_wb_sel[3:0];
+assign        periph_wb_dout  = (WB_DATA_WIDTH == 64 && data_wb_adr[2]) ? data_wb_dout[WB_DATA_WIDTH-1 -: 32] : data_wb_dout[31:0];
+
 // Wishbone fabric.
 always @*
 begin:blk1
@@ -366,35 +462,35 @@ begin:blk1
                 data_wb_cyc_uart[0] = data_wb_cyc;
                 data_wb_stb_uart[0] = data_wb_stb;
                 data_wb_ack        = data_wb_ack_uart[0];
-                data_wb_din        = data_wb_din_uart[0];
+                data_wb_din        = {(WB_DATA_WIDTH/32){data_wb_din_uart[0]}};
         end
         else if ( data_wb_adr >= TIMER0_LO && data_wb_adr <= TIMER0_HI )  // Timer0 access
         begin
                 data_wb_cyc_timer[0] = data_wb_cyc;
                 data_wb_stb_timer[0] = data_wb_stb;
                 data_wb_ack          = data_wb_ack_timer[0];
-                data_wb_din          = data_wb_din_timer[0];
+                data_wb_din          = {(WB_DATA_WIDTH/32){data_wb_din_timer[0]}};
         end
         else if ( data_wb_adr >= VIC_LO && data_wb_adr <= VIC_HI )        // VIC access.
         begin
                 data_wb_cyc_vic   = data_wb_cyc;
                 data_wb_stb_vic   = data_wb_stb;
                 data_wb_ack       = data_wb_ack_vic;
-                data_wb_din       = data_wb_din_vic;
+                data_wb_din       = {(WB_DATA_WIDTH/32){data_wb_din_vic}};
         end
         else if ( data_wb_adr >= UART1_LO && data_wb_adr <= UART1_HI )    // UART1 access
         begin
                 data_wb_cyc_uart[1] = data_wb_cyc;
                 data_wb_stb_uart[1] = data_wb_stb;
                 data_wb_ack        = data_wb_ack_uart[1];
-                data_wb_din        = data_wb_din_uart[1];
+                data_wb_din        = {(WB_DATA_WIDTH/32){data_wb_din_uart[1]}};
         end
         else if ( data_wb_adr >= TIMER1_LO && data_wb_adr <= TIMER1_HI )  // Timer1 access
         begin
                 data_wb_cyc_timer[1] = data_wb_cyc;
                 data_wb_stb_timer[1] = data_wb_stb;
                 data_wb_ack          = data_wb_ack_timer[1];
-                data_wb_din          = data_wb_din_timer[1];
+                data_wb_din          = {(WB_DATA_WIDTH/32){data_wb_din_timer[1]}};
         end
         else // External WB access.
         begin
@@ -406,45 +502,120 @@ begin:blk1
 end
 
 // =========================
-// Processor core.
+// Processor core(s).
 // =========================
 
-zap_top #(
-        .CP15_L4_DEFAULT(1'd1),
-        .BE_32_ENABLE(BE_32_ENABLE),
-        .ONLY_CORE(ONLY_CORE),
-        .FIFO_DEPTH(FIFO_DEPTH),
-        .BP_ENTRIES(BP_ENTRIES),
-        .DATA_SECTION_TLB_ENTRIES(DATA_SECTION_TLB_ENTRIES),
-        .DATA_LPAGE_TLB_ENTRIES(DATA_LPAGE_TLB_ENTRIES),
-        .DATA_SPAGE_TLB_ENTRIES(DATA_SPAGE_TLB_ENTRIES),
-        .DATA_FPAGE_TLB_ENTRIES(DATA_FPAGE_TLB_ENTRIES),
-        .DATA_CACHE_SIZE(DATA_CACHE_SIZE),
-        .CODE_SECTION_TLB_ENTRIES(CODE_SECTION_TLB_ENTRIES),
-        .CODE_LPAGE_TLB_ENTRIES(CODE_LPAGE_TLB_ENTRIES),
-        .CODE_SPAGE_TLB_ENTRIES(CODE_SPAGE_TLB_ENTRIES),
-        .CODE_FPAGE_TLB_ENTRIES(CODE_FPAGE_TLB_ENTRIES),
-        .CODE_CACHE_SIZE(CODE_CACHE_SIZE)
-)
-u_zap_top
-(
-        .i_clk    (i_clk),
-        .i_reset  (i_reset),
-        .i_irq    (int_sel == 1'd0 ? global_irq : I_FIQ),
-        .i_fiq    (int_sel == 1'd1 ? global_irq : I_FIQ),
-        .o_wb_cyc (data_wb_cyc),
-        .o_wb_stb (data_wb_stb),
-        .o_wb_adr (data_wb_adr),
-        .o_wb_we  (data_wb_we),
-        .o_wb_cti (data_wb_cti),
-        .i_wb_dat (data_wb_din),
-        .o_wb_dat (data_wb_dout),
-        .i_wb_ack (data_wb_ack),
-        .i_wb_err (1'd0),
-        .o_wb_sel (data_wb_sel),
-        .o_wb_bte ()             // Always zero (Linear)
-
-);
+generate
+if ( CORES == 1 )
+begin : l_cpu
+
+        wire trace_valid, trace_uop_last;
+
+        zap_top #(
+                .CP15_L4_DEFAULT(1'd1),
+                .WB_DATA_WIDTH(WB_DATA_WIDTH),
+                .BE_32_ENABLE(BE_32_ENABLE),
+                .ONLY_CORE(ONLY_CORE),
+                .FIFO_DEPTH(FIFO_DEPTH),
+                .LOOP_BUFFER_DEPTH(LOOP_BUFFER_DEPTH),
+                .BP_ENTRIES(BP_ENTRIES),
+                .DATA_SECTION_TLB_ENTRIES(DATA_SECTION_TLB_ENTRIES),
+                .DATA_LPAGE_TLB_ENTRIES(DATA_LPAGE_TLB_ENTRIES),
+                .DATA_SPAGE_TLB_ENTRIES(DATA_SPAGE_TLB_ENTRIES),
+                .DATA_FPAGE_TLB_ENTRIES(DATA_FPAGE_TLB_ENTRIES),
+                .DATA_CACHE_SIZE(DATA_CACHE_SIZE),
+                .DATA_CACHE_BG_WRITEBACK(DATA_CACHE_BG_WRITEBACK),
+                .CODE_SECTION_TLB_ENTRIES(CODE_SECTION_TLB_ENTRIES),
+                .CODE_LPAGE_TLB_ENTRIES(CODE_LPAGE_TLB_ENTRIES),
+                .CODE_SPAGE_TLB_ENTRIES(CODE_SPAGE_TLB_ENTRIES),
+                .CODE_FPAGE_TLB_ENTRIES(CODE_FPAGE_TLB_ENTRIES),
+                .CODE_CACHE_SIZE(CODE_CACHE_SIZE)
+        )
+        u_zap_top
+        (
+                .o_trace  (),
+                .o_trace_valid(trace_valid),
+                .o_trace_uop_last(trace_uop_last),
+                .i_clk    (i_clk),
+                .i_reset  (i_reset),
+                .i_irq    (int_sel == 1'd0 ? global_irq : I_FIQ),
+                .i_fiq    (int_sel == 1'd1 ? global_irq : I_FIQ),
+                .o_wb_cyc (data_wb_cyc),
+                .o_wb_stb (data_wb_stb),
+                .o_wb_adr (data_wb_adr),
+                .o_wb_we  (data_wb_we),
+                .o_wb_cti (data_wb_cti),
+                .i_wb_dat (data_wb_din),
+                .o_wb_dat (data_wb_dout),
+                .i_wb_ack (data_wb_ack),
+                .i_wb_err (1'd0),
+                .o_wb_sel (data_wb_sel),
+                .o_wb_bte ()             // Always zero (Linear)
+
+        );
+
+        assign O_CPU_RETIRE = {31'd0, trace_valid & trace_uop_last};
+        assign O_BUS_REQ    = {31'd0, data_wb_cyc & data_wb_stb};
+        assign O_BUS_GNT    = O_BUS_REQ;
+end
+else
+begin : l_cluster
+
+        wire [CORES-1:0] trace_valid, trace_uop_last, bus_req, bus_gnt;
+
+        // Peripheral interrupts go to CPU 0.
+        zap_cluster #(
+                .CORES(CORES),
+                .MBOX_BASE(MBOX_LO),
+                .CP15_L4_DEFAULT(1'd1),
+                .WB_DATA_WIDTH(WB_DATA_WIDTH),
+                .BE_32_ENABLE(BE_32_ENABLE),
+                .ONLY_CORE(ONLY_CORE),
+                .FIFO_DEPTH(FIFO_DEPTH),
+                .LOOP_BUFFER_DEPTH(LOOP_BUFFER_DEPTH),
+                .BP_ENTRIES(BP_ENTRIES),
+                .DATA_SECTION_TLB_ENTRIES(DATA_SECTION_TLB_ENTRIES),
+                .DATA_LPAGE_TLB_ENTRIES(DATA_LPAGE_TLB_ENTRIES),
+                .DATA_SPAGE_TLB_ENTRIES(DATA_SPAGE_TLB_ENTRIES),
+                .DATA_FPAGE_TLB_ENTRIES(DATA_FPAGE_TLB_ENTRIES),
+                .DATA_CACHE_SIZE(DATA_CACHE_SIZE),
+                .DATA_CACHE_BG_WRITEBACK(DATA_CACHE_BG_WRITEBACK),
+                .CODE_SECTION_TLB_ENTRIES(CODE_SECTION_TLB_ENTRIES),
+                .CODE_LPAGE_TLB_ENTRIES(CODE_LPAGE_TLB_ENTRIES),
+                .CODE_SPAGE_TLB_ENTRIES(CODE_SPAGE_TLB_ENTRIES),
+                .CODE_FPAGE_TLB_ENTRIES(CODE_FPAGE_TLB_ENTRIES),
+                .CODE_CACHE_SIZE(CODE_CACHE_SIZE)
+        )
+        u_zap_cluster
+        (
+                .o_trace  (),
+                .o_trace_valid(trace_valid),
+                .o_trace_uop_last(trace_uop_last),
+                .i_clk    (i_clk),
+                .i_reset  (i_reset),
+                .i_irq    ({{(CORES-1){1'd0}}, int_sel == 1'd0 ? global_irq : I_FIQ}),
+                .i_fiq    ({{(CORES-1){1'd0}}, int_sel == 1'd1 ? global_irq : I_FIQ}),
+                .i_qos    (CORE_QOS[2*CORES-1:0]),
+                .o_wb_cyc (data_wb_cyc),
+                .o_wb_stb (data_wb_stb),
+                .o_wb_adr (data_wb_adr),
+                .o_wb_we  (data_wb_we),
+                .o_wb_cti (data_wb_cti),
+                .i_wb_dat (data_wb_din),
+                .o_wb_dat (data_wb_dout),
+                .i_wb_ack (data_wb_ack),
+                .i_wb_err (1'd0),
+                .o_wb_sel (data_wb_sel),
+                .o_wb_bte (),            // Always zero (Linear)
+                .o_bus_req(bus_req),
+                .o_bus_gnt(bus_gnt)
+        );
+
+        assign O_CPU_RETIRE = {{(32-CORES){1'd0}}, trace_valid & trace_uop_last};
+        assign O_BUS_REQ    = {{(32-CORES){1'd0}}, bus_req};
+        assign O_BUS_GNT    = {{(32-CORES){1'd0}}, bus_gnt};
+end
+endgenerate
 
 // ===============================
 // 2 x UART + 2 x Timer
@@ -460,12 +631,12 @@ generate
                         .wb_clk_i(i_clk),
                         .wb_rst_i(i_reset),
                         .wb_adr_i(data_wb_adr[4:0]),
-                        .wb_dat_i(data_wb_dout),
+                        .wb_dat_i(periph_wb_dout),
                         .wb_dat_o(data_wb_din_uart[gi]),
                         .wb_we_i (data_wb_we),
                         .wb_stb_i(data_wb_stb_uart[gi]),
                         .wb_cyc_i(data_wb_cyc_uart[gi]),
-                        .wb_sel_i(data_wb_sel),
+                        .wb_sel_i(periph_wb_sel),
                         .wb_ack_o(data_wb_ack_uart[gi]),
                         .int_o   (uart_irq[gi]), // Interrupt.
 
@@ -486,11 +657,11 @@ generate
                         .i_clk(i_clk),
                         .i_rst(i_reset),
                         .i_wb_adr(data_wb_adr[3:0]),
-                        .i_wb_dat(data_wb_dout),
+                        .i_wb_dat(periph_wb_dout),
                         .i_wb_stb(data_wb_stb_timer[gi]),
                         .i_wb_cyc(data_wb_cyc_timer[gi]),   // From core
                         .i_wb_wen(data_wb_we),
-                        .i_wb_sel(data_wb_sel),
+                        .i_wb_sel(periph_wb_sel),
                         .o_wb_dat(data_wb_din_timer[gi]),   // To core.
                         .o_wb_ack(data_wb_ack_timer[gi]),
                         .o_irq(timer_irq[gi])               // Interrupt
@@ -506,11 +677,11 @@ vic #(.SOURCES(32)) u_vic (
         .i_clk   (i_clk),
         .i_rst   (i_reset),
         .i_wb_adr(data_wb_adr[3:0]),
-        .i_wb_dat(data_wb_dout),
+        .i_wb_dat(periph_wb_dout),
         .i_wb_stb(data_wb_stb_vic),
         .i_wb_cyc(data_wb_cyc_vic), // From core
         .i_wb_wen(data_wb_we),
-        .i_wb_sel(data_wb_sel),
+        .i_wb_sel(periph_wb_sel),
         .o_wb_dat(data_wb_din_vic), // To core.
         .o_wb_ack(data_wb_ack_vic),
         .i_irq({I_IRQ, timer_irq[1], uart_irq[1], timer_irq[0], uart_irq[0]}), // Concatenate 32 interrupt sources.
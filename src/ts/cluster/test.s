@@ -0,0 +1,189 @@
+//
+// (C) 2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+//
+
+//
+// Tests a 4 CPU cluster. All CPUs run this code. Each CPU reads its ID from
+// CP15 and sums 1..100*(ID+1) into its own cache line in RES. CPUs 1..3 then
+// post to the mailbox of CPU 0, which waits for all of them and replies to
+// each. CPUs 1..3 wait for the reply with IRQs enabled. The mailbox IRQ
+// handler reads the reply and clears PEND. Each CPU cleans its D-cache so
+// that results reach memory.
+//
+
+.global _Reset
+
+// Set up an interrupt vector table.
+_Reset   : b there
+_Undef   : b _Undef
+_Swi     : b _Swi
+_Pabt    : b _Pabt
+_Dabt    : b _Dabt
+reserved : b reserved
+irq      : b irq_handler
+fiq      : b fiq
+
+there:
+
+// Get CPU ID.
+mrc p15, 0, r10, c0, c0, 5
+
+// Each CPU gets its own stack.
+.set SVC_SP_VALUE, 4000
+ldr sp, =SVC_SP_VALUE
+sub sp, sp, r10, lsl #8
+
+// Enable cache (Uses a single bit to enable both caches).
+.set ENABLE_CACHE_CP_WORD, 4100
+ldr r1, =ENABLE_CACHE_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Write out identitiy section mapping. Write 16KB to register 2.
+mov r1, #1
+mov r1, r1, lsl #14
+mcr p15, 0, r1, c2, c0, 1
+
+// Set domain access control to all 1s.
+mvn r1, #0
+mcr p15, 0, r1, c3, c0, 0
+
+// Set up a section desctiptor for identity mapping that is Cachaeable.
+// All CPUs write the same page table.
+mov r1, #1
+mov r1, r1, lsl #14     // 16KB
+mov r2, #14             // Cacheable identity descriptor.
+str r2, [r1]            // Write identity section desctiptor to 16KB location.
+
+// Set up a section descriptor for upper 1MB of virtual address space.
+// This is identity mapping. Uncacheable. The mailbox is here.
+.set DESCRIPTOR_IO_SECTION_OFFSET, 16380 // 4095 x 4
+ldr r2,=DESCRIPTOR_IO_SECTION_OFFSET
+add r1, r1, r2
+
+// Prepare a descriptor. Descriptor = 0xFFF00002 (Uncacheable section descriptor).
+.set DESCRIPTOR_IO_SECTION, 0xFFF00002
+ldr r2 ,=DESCRIPTOR_IO_SECTION
+str r2, [r1]
+
+// ENABLE MMU
+.set ENABLE_MMU_CP_WORD, 4101
+ldr r1, =ENABLE_MMU_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Result area. One cache line per CPU as the caches are not coherent.
+.set RES,  0x9100
+.set MBOX, 0xFFFFFF40
+
+ldr r9, =RES
+add r9, r9, r10, lsl #6
+ldr r8, =MBOX
+
+// Sum of 1..100*(ID+1).
+mov r0, #0
+mov r1, #100
+mul r1, r10, r1
+add r1, r1, #100
+sum_loop:
+add r0, r0, r1
+subs r1, r1, #1
+bne sum_loop
+str r0, [r9, #0]
+
+cmp r10, #0
+bne secondary
+
+// CPU 0 : Wait for CPUs 1..3 to post.
+wait_all:
+ldr r1, [r8, #4]
+cmp r1, #0xE
+bne wait_all
+
+// Clear PEND and read it back.
+str r1, [r8, #4]
+ldr r1, [r8, #4]
+str r1, [r9, #4]
+ldr r1, =0x600D
+str r1, [r9, #8]
+
+// Reply 0x100 + N to CPU N.
+mov r2, #1
+reply_loop:
+add r1, r2, #0x100
+str r1, [r8, r2, lsl #3]
+add r2, r2, #1
+cmp r2, #4
+bne reply_loop
+
+// Clean D cache so that results reach memory.
+mov r4, #0
+mcr p15, 0, r4, c7, c10, 0
+
+// Call C code
+bl main
+
+// Loop forever
+here: b here
+
+// CPU 1..3 : Set up an IRQ mode stack.
+secondary:
+mrs r1, cpsr
+bic r2, r1, #31
+orr r2, r2, #18
+msr cpsr_c, r2
+.set IRQ_SP_VALUE, 3000
+ldr sp, =IRQ_SP_VALUE
+sub sp, sp, r10, lsl #8
+msr cpsr_c, r1
+
+// Post ID to CPU 0 and wait for the reply with IRQs enabled. The IRQ handler
+// sets r11.
+mov r11, #0
+add r7, r8, r10, lsl #3
+bic r1, r1, #0x80
+msr cpsr_c, r1
+str r10, [r8, #0]
+wait_reply:
+cmp r11, #0
+beq wait_reply
+
+// PEND after the handler cleared it.
+ldr r1, [r7, #4]
+str r1, [r9, #12]
+
+// Clean D cache so that results reach memory.
+mov r4, #0
+mcr p15, 0, r4, c7, c10, 0
+
+// Loop forever
+there_forever: b there_forever
+
+// Mailbox IRQ handler for CPUs 1..3. Uses r7..r10 from the secondary code.
+irq_handler:
+stmfd sp!, {r0-r1}
+ldr r0, [r7, #4]                // PEND.
+cmp r0, #0
+beq irq_done
+str r0, [r9, #8]                // CPU 0 posted.
+ldr r1, [r7, #0]
+add r1, r1, r10
+str r1, [r9, #4]                // Reply.
+str r0, [r7, #4]                // Clear PEND.
+mov r11, #1
+irq_done:
+ldmfd sp!, {r0-r1}
+subs pc, lr, #4
@@ -0,0 +1,158 @@
+//
+// (C) 2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+//
+
+//
+// Tests data cache clean and invalidate by VA and by VA range. Results are
+// written to RES and are checked after a global clean at the end.
+//
+
+.global _Reset
+
+// Set up an interrupt vector table.
+_Reset   : b there
+_Undef   : b _Undef
+_Swi     : b _Swi
+_Pabt    : b _Pabt
+_Dabt    : b _Dabt
+reserved : b reserved
+irq      : b irq
+fiq      : b fiq
+
+there:
+
+.set SVC_SP_VALUE, 4000
+ldr sp, =SVC_SP_VALUE
+
+// Enable cache (Uses a single bit to enable both caches).
+.set ENABLE_CACHE_CP_WORD, 4100
+ldr r1, =ENABLE_CACHE_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Write out identitiy section mapping. Write 16KB to register 2.
+mov r1, #1
+mov r1, r1, lsl #14
+mcr p15, 0, r1, c2, c0, 1
+
+// Set domain access control to all 1s.
+mvn r1, #0
+mcr p15, 0, r1, c3, c0, 0
+
+// Set up a section desctiptor for identity mapping that is Cachaeable.
+mov r1, #1
+mov r1, r1, lsl #14     // 16KB
+mov r2, #14             // Cacheable identity descriptor.
+str r2, [r1]            // Write identity section desctiptor to 16KB location.
+
+// Set up a section descriptor for upper 1MB of virtual address space.
+// This is identity mapping. Uncacheable.
+.set DESCRIPTOR_IO_SECTION_OFFSET, 16380 // 4095 x 4
+ldr r2,=DESCRIPTOR_IO_SECTION_OFFSET
+add r1, r1, r2
+
+// Prepare a descriptor. Descriptor = 0xFFF00002 (Uncacheable section descriptor).
+.set DESCRIPTOR_IO_SECTION, 0xFFF00002
+ldr r2 ,=DESCRIPTOR_IO_SECTION
+str r2, [r1]
+
+// ENABLE MMU
+.set ENABLE_MMU_CP_WORD, 4101
+ldr r1, =ENABLE_MMU_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Buffer and result area. Lines do not alias in a 4KB cache.
+.set BUF, 0x9000
+.set RES, 0x9100
+
+ldr r8, =BUF
+ldr r9, =RES
+
+// Clean line. Data written back must survive an invalidate.
+ldr r1, =0x11111111
+str r1, [r8]
+mcr p15, 0, r8, c7, c10, 1      // Clean D line.
+mcr p15, 0, r8, c7, c6, 1       // Invalidate D line.
+ldr r2, [r8]
+str r2, [r9, #0]
+
+// Invalidate line. Dirty data is discarded. Any VA in the line works.
+ldr r1, =0x22222222
+str r1, [r8, #0x40]
+add r0, r8, #0x44
+mcr p15, 0, r0, c7, c6, 1       // Invalidate D line.
+ldr r2, [r8, #0x40]
+str r2, [r9, #4]
+
+// Clean and invalidate a range of 3 lines. Line after the range is untouched.
+add r0, r8, #0x200
+ldr r1, =0x33333333
+str r1, [r0, #0x00]
+str r1, [r0, #0x40]
+str r1, [r0, #0x80]
+ldr r1, =0x44444444
+str r1, [r0, #0xC0]
+add r1, r0, #0xBC
+mcr p15, 0, r0, c7, c12, 4      // Range start.
+mcr p15, 0, r1, c7, c12, 5      // Range end. Inclusive.
+mcr p15, 0, r0, c7, c14, 5      // Clean and invalidate D range.
+ldr r2, [r0, #0x00]
+ldr r3, [r0, #0x40]
+ldr r4, [r0, #0x80]
+add r2, r2, r3
+add r2, r2, r4
+str r2, [r9, #8]
+ldr r2, [r0, #0xC0]             // Must still be in cache.
+str r2, [r9, #12]
+add r1, r0, #0xC0
+mcr p15, 0, r1, c7, c6, 1       // Invalidate D line.
+ldr r2, [r0, #0xC0]             // Must not have been written back.
+str r2, [r9, #16]
+
+// Clean range, dirty the line again and invalidate range.
+add r0, r8, #0x300
+ldr r1, =0x55555555
+str r1, [r0]
+mcr p15, 0, r0, c7, c12, 4      // Range start.
+mcr p15, 0, r0, c7, c12, 5      // Range end.
+mcr p15, 0, r0, c7, c10, 5      // Clean D range.
+ldr r1, =0x66666666
+str r1, [r0]
+mcr p15, 0, r0, c7, c6, 5       // Invalidate D range.
+ldr r2, [r0]
+str r2, [r9, #20]
+
+// Empty range (end < start) does nothing.
+add r0, r8, #0x340
+ldr r1, =0x77777777
+str r1, [r0]
+add r1, r0, #0x40
+mcr p15, 0, r1, c7, c12, 4      // Range start.
+mcr p15, 0, r0, c7, c12, 5      // Range end.
+mcr p15, 0, r0, c7, c6, 5       // Invalidate D range.
+ldr r2, [r0]
+str r2, [r9, #24]
+
+// Clean and flush everything so that results reach memory.
+mov r4, #0
+mcr p15, 0, r4, c7, c15, 0
+
+// Call C code
+bl main
+
+// Loop forever
+here: b here
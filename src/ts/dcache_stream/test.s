@@ -0,0 +1,156 @@
+//
+// (C) 2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+//
+
+//
+// Tests streaming stores. A full line of stores is allocated without a line
+// fill. A partial line is written out with only the written bytes enabled
+// and is not allocated. Memory behind the partial line is written through an
+// uncacheable alias while the stream is open. A line fill would have loaded
+// the old data, and a later write back would have overwritten the new data.
+// Results are written to RES and are checked after a global clean at the end.
+//
+
+.global _Reset
+
+// Set up an interrupt vector table.
+_Reset   : b there
+_Undef   : b _Undef
+_Swi     : b _Swi
+_Pabt    : b _Pabt
+_Dabt    : b _Dabt
+reserved : b reserved
+irq      : b irq
+fiq      : b fiq
+
+there:
+
+.set SVC_SP_VALUE, 4000
+ldr sp, =SVC_SP_VALUE
+
+// Enable cache and streaming stores.
+.set ENABLE_CACHE_CP_WORD, 5124
+ldr r1, =ENABLE_CACHE_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Write out identitiy section mapping. Write 16KB to register 2.
+mov r1, #1
+mov r1, r1, lsl #14
+mcr p15, 0, r1, c2, c0, 1
+
+// Set domain access control to all 1s.
+mvn r1, #0
+mcr p15, 0, r1, c3, c0, 0
+
+// Set up a section desctiptor for identity mapping that is Cachaeable.
+mov r1, #1
+mov r1, r1, lsl #14     // 16KB
+mov r2, #14             // Cacheable identity descriptor.
+str r2, [r1]            // Write identity section desctiptor to 16KB location.
+
+// Set up a section descriptor that maps the second 1MB of virtual address
+// space to the first 1MB. Uncacheable.
+.set ALIAS, 0x100000
+mov r2, #2              // Uncacheable section descriptor. PA = 0.
+str r2, [r1, #4]
+
+// Set up a section descriptor for upper 1MB of virtual address space.
+// This is identity mapping. Uncacheable.
+.set DESCRIPTOR_IO_SECTION_OFFSET, 16380 // 4095 x 4
+ldr r2,=DESCRIPTOR_IO_SECTION_OFFSET
+add r1, r1, r2
+
+// Prepare a descriptor. Descriptor = 0xFFF00002 (Uncacheable section descriptor).
+.set DESCRIPTOR_IO_SECTION, 0xFFF00002
+ldr r2 ,=DESCRIPTOR_IO_SECTION
+str r2, [r1]
+
+// ENABLE MMU
+.set ENABLE_MMU_CP_WORD, 5125
+ldr r1, =ENABLE_MMU_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Buffer and result area. Lines do not alias in a 4KB cache.
+.set BUF, 0x9000
+.set RES, 0x9100
+
+ldr r8, =BUF
+ldr r9, =RES
+
+// Full line. 16 words are gathered and the line is allocated.
+mov r0, #0xF
+mov r1, #0xF
+mov r2, #0xF
+mov r3, #0xF
+mov r4, r8
+stmia r4!, {r0-r3}
+stmia r4!, {r0-r3}
+stmia r4!, {r0-r3}
+stmia r4!, {r0-r3}
+mcr p15, 0, r8, c7, c14, 1      // Clean and invalidate D line.
+ldr r2, [r8]
+str r2, [r9, #0]
+ldr r2, [r8, #0x3C]
+str r2, [r9, #4]
+
+// Partial line. Set up memory first.
+add r0, r8, #0x40
+ldr r1, =0xAAAAAAAA
+mov r2, r1
+mov r3, r1
+mov r5, r1
+mov r4, r0
+stmia r4!, {r1-r3, r5}
+stmia r4!, {r1-r3, r5}
+stmia r4!, {r1-r3, r5}
+stmia r4!, {r1-r3, r5}
+mcr p15, 0, r0, c7, c14, 1      // Clean and invalidate D line.
+
+// Write a word and a byte. The store through the alias breaks the stream.
+ldr r1, =0x12345678
+str r1, [r0]
+mov r1, #0x5A
+strb r1, [r0, #4]
+ldr r1, =0xBBBBBBBB
+add r3, r0, #ALIAS
+str r1, [r3, #8]
+ldr r2, [r0]
+str r2, [r9, #8]
+ldr r2, [r0, #4]
+str r2, [r9, #12]
+ldr r2, [r0, #8]
+str r2, [r9, #16]
+ldr r2, [r0, #12]
+str r2, [r9, #24]
+
+// A store that does not start a stream still works.
+add r0, r8, #0xC0
+mov r1, #1
+str r1, [r0, #4]
+ldr r2, [r0, #4]
+str r2, [r9, #20]
+
+// Clean and flush everything so that results reach memory.
+mov r4, #0
+mcr p15, 0, r4, c7, c15, 0
+
+// Call C code
+bl main
+
+// Loop forever
+here: b here
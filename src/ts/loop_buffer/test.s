@@ -0,0 +1,182 @@
+//
+// (C) 2016-2024 Revanth Kamaraj (krevanth) <revanth91kamaraj@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+//
+
+//
+// Tests the loop buffer. Tight loops are run to completion and exited by
+// branch mispredict. A loop is patched in memory and rerun after an I-cache
+// flush to check that stale code is not replayed. Another loop patches its
+// own body while it is being replayed. Results are written to RES.
+//
+
+.global _Reset
+
+// Set up an interrupt vector table.
+_Reset   : b there
+_Undef   : b _Undef
+_Swi     : b _Swi
+_Pabt    : b _Pabt
+_Dabt    : b _Dabt
+reserved : b reserved
+irq      : b irq
+fiq      : b fiq
+
+there:
+
+.set SVC_SP_VALUE, 4000
+ldr sp, =SVC_SP_VALUE
+
+// Enable cache (Uses a single bit to enable both caches).
+.set ENABLE_CACHE_CP_WORD, 4100
+ldr r1, =ENABLE_CACHE_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Write out identitiy section mapping. Write 16KB to register 2.
+mov r1, #1
+mov r1, r1, lsl #14
+mcr p15, 0, r1, c2, c0, 1
+
+// Set domain access control to all 1s.
+mvn r1, #0
+mcr p15, 0, r1, c3, c0, 0
+
+// Set up a section desctiptor for identity mapping that is Cachaeable.
+mov r1, #1
+mov r1, r1, lsl #14     // 16KB
+mov r2, #14             // Cacheable identity descriptor.
+str r2, [r1]            // Write identity section desctiptor to 16KB location.
+
+// Set up a section descriptor for upper 1MB of virtual address space.
+// This is identity mapping. Uncacheable.
+.set DESCRIPTOR_IO_SECTION_OFFSET, 16380 // 4095 x 4
+ldr r2,=DESCRIPTOR_IO_SECTION_OFFSET
+add r1, r1, r2
+
+// Prepare a descriptor. Descriptor = 0xFFF00002 (Uncacheable section descriptor).
+.set DESCRIPTOR_IO_SECTION, 0xFFF00002
+ldr r2 ,=DESCRIPTOR_IO_SECTION
+str r2, [r1]
+
+// ENABLE MMU
+.set ENABLE_MMU_CP_WORD, 4101
+ldr r1, =ENABLE_MMU_CP_WORD
+mcr p15, 0, r1, c1, c1, 0
+
+// Buffer and result area.
+.set BUF, 0x9000
+.set RES, 0x9100
+
+ldr r8, =BUF
+ldr r9, =RES
+
+// Sum of 1..100.
+mov r0, #0
+mov r1, #100
+sum_loop:
+add r0, r0, r1
+subs r1, r1, #1
+bne sum_loop
+str r0, [r9, #0]
+
+// Fill BUF with 1..16 and then sum it up with a load loop.
+mov r1, #1
+mov r2, #16
+mov r3, r8
+fill_loop:
+str r1, [r3], #4
+add r1, r1, #1
+subs r2, r2, #1
+bne fill_loop
+mov r0, #0
+mov r2, #16
+mov r3, r8
+load_loop:
+ldr r4, [r3], #4
+add r0, r0, r4
+subs r2, r2, #1
+bne load_loop
+str r0, [r9, #4]
+
+// Run a loop, patch it and run it again.
+bl smc_func
+str r0, [r9, #8]
+ldr r1, =0xE2800002             // add r0, r0, #2
+ldr r2, =smc_insn
+str r1, [r2]
+mcr p15, 0, r2, c7, c10, 1      // Clean D line.
+mov r1, #0
+mcr p15, 0, r1, c7, c5, 0       // Flush I cache.
+bl smc_func
+str r0, [r9, #12]
+
+// Patch the loop body from within the loop, half way through. The I-cache
+// flush ends the replay. Instructions already fetched may still run stale,
+// so only check that most of the remaining passes use the new code. With
+// the new code the sum is 17 + (15 x 2) = 47. Stale code gives 32.
+mov r0, #0
+mov r1, #32
+ldr r5, =0xE2800002             // add r0, r0, #2
+ldr r2, =smc2_insn
+mov r6, #0
+smc2_loop:
+smc2_insn:
+add r0, r0, #1
+cmp r1, #16
+streq r5, [r2]
+mcreq p15, 0, r2, c7, c10, 1    // Clean D line.
+mcreq p15, 0, r6, c7, c5, 0     // Flush I cache.
+subs r1, r1, #1
+bne smc2_loop
+cmp r0, #40
+movhi r0, #1
+movls r0, #0
+str r0, [r9, #20]
+
+// Nested loop. Inner loop is captured again on every outer iteration.
+mov r0, #0
+mov r3, #10
+outer_loop:
+mov r2, #10
+inner_loop:
+add r0, r0, #1
+subs r2, r2, #1
+bne inner_loop
+subs r3, r3, #1
+bne outer_loop
+str r0, [r9, #16]
+
+// Clean and flush everything so that results reach memory.
+mov r4, #0
+mcr p15, 0, r4, c7, c15, 0
+
+// Call C code
+bl main
+
+// Loop forever
+here: b here
+
+// Loop whose body is patched by the test.
+smc_func:
+mov r0, #0
+mov r1, #32
+smc_loop:
+smc_insn:
+add r0, r0, #1
+subs r1, r1, #1
+bne smc_loop
+mov pc, lr
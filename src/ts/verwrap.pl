@@ -39,7 +39,14 @@ my $DATA_SPAGE_TLB_ENTRIES      = $Config{'DATA_SPAGE_TLB_ENTRIES'};
 my $DATA_LPAGE_TLB_ENTRIES      = $Config{'DATA_LPAGE_TLB_ENTRIES'};
 my $BP                          = $Config{'BP_DEPTH'};
 my $FIFO                        = $Config{'INSTR_FIFO_DEPTH'};
-my $REG_HIER                    = "u_chip_top.u_zap_top.u_zap_core.u_zap_writeback.u_zap_register_file";
+my $LOOP_BUFFER_DEPTH           = $Config{'LOOP_BUFFER_DEPTH'} // 0;
+my $DATA_CACHE_BG_WRITEBACK     = $Config{'DATA_CACHE_BG_WRITEBACK'} // 0;
+my $CORES                       = $Config{'CORES'} // 1;
+my $CORE_QOS                    = $Config{'CORE_QOS'} // 0;
+my $WB_DATA_WIDTH               = $Config{'WB_DATA_WIDTH'} // 32;
+my $BE_32_ENABLE                = $Config{'BE_32_ENABLE'} // 0;
+my $CPU0_HIER                   = $CORES == 1 ? "u_chip_top.l_cpu.u_zap_top" : "u_chip_top.l_cluster.u_zap_cluster.l_core[0].u_zap_top";
+my $REG_HIER                    = "$CPU0_HIER.u_zap_core.u_zap_writeback.u_zap_register_file";
 
 my $IVL_OPTIONS  = " -Isrc/rtl ";
    $IVL_OPTIONS .= "   src/rtl/*.sv ";
@@ -47,6 +54,7 @@ my $IVL_OPTIONS  = " -Isrc/rtl ";
    $IVL_OPTIONS .= "   src/testbench/*.v ";
    $IVL_OPTIONS .= " -GBP_ENTRIES=$BP ";
    $IVL_OPTIONS .= " -GFIFO_DEPTH=$FIFO ";
+   $IVL_OPTIONS .= " -GLOOP_BUFFER_DEPTH=$LOOP_BUFFER_DEPTH ";
    $IVL_OPTIONS .= " -GDATA_SECTION_TLB_ENTRIES=$DATA_SECTION_TLB_ENTRIES ";
    $IVL_OPTIONS .= " -GDATA_LPAGE_TLB_ENTRIES=$DATA_LPAGE_TLB_ENTRIES ";
    $IVL_OPTIONS .= " -GDATA_SPAGE_TLB_ENTRIES=$DATA_SPAGE_TLB_ENTRIES ";
@@ -55,11 +63,17 @@ my $IVL_OPTIONS  = " -Isrc/rtl ";
    $IVL_OPTIONS .= " -GCODE_LPAGE_TLB_ENTRIES=$CODE_LPAGE_TLB_ENTRIES ";
    $IVL_OPTIONS .= " -GCODE_SPAGE_TLB_ENTRIES=$CODE_SPAGE_TLB_ENTRIES ";
    $IVL_OPTIONS .= " -GCODE_CACHE_SIZE=$CODE_CACHE_SIZE ";
+   $IVL_OPTIONS .= " -GDATA_CACHE_BG_WRITEBACK=$DATA_CACHE_BG_WRITEBACK ";
    $IVL_OPTIONS .= " -GONLY_CORE=$ONLY_CORE ";
+   $IVL_OPTIONS .= " -GCORES=$CORES ";
+   $IVL_OPTIONS .= " -GCORE_QOS=$CORE_QOS ";
+   $IVL_OPTIONS .= " -GWB_DATA_WIDTH=$WB_DATA_WIDTH ";
+   $IVL_OPTIONS .= " -GBE_32_ENABLE=$BE_32_ENABLE ";
    $IVL_OPTIONS .= " +define+MAX_CLOCK_CYCLES=$MAX_CLOCK_CYCLES ";
    $IVL_OPTIONS .= " +define+IRQ_EN "      if ( $IRQ_EN    );
    $IVL_OPTIONS .= " +define+FIQ_EN "      if ( $FIQ_EN    );
-   $IVL_OPTIONS .= " +define+REG_HIER=$REG_HIER ";
+   $IVL_OPTIONS .= " +define+REG_HIER='$REG_HIER' ";
+   $IVL_OPTIONS .= " +define+CPU_HIER='$CPU0_HIER' ";
    $IVL_OPTIONS .= " --trace ";;
 
 if ( @ARGV==3 ) {